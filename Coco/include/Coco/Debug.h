@@ -12,16 +12,20 @@
 
 #pragma once
 
-#include <functional>
 #include <utility>
 
 #include <QObject>
 #include <QString>
 #include <QStringView>
 #include <QtLogging>
+#include <QtTypes>
 
 #include "Coco/Fmt.h"
+#include "Coco/LogCategory.h"
+#include "Coco/LogRecord.h"
+#include "Coco/LogSink.h"
 #include "Coco/Path.h"
+#include "Coco/ToQString.h"
 
 // TODO: Address macro pollution? COCO_ prefix on macros? (COCO_DEBUG is free
 // now that assertion gating uses COCO_HAS_ASSERTIONS)
@@ -29,7 +33,6 @@
 namespace Coco::Debug {
 
 using namespace Qt::StringLiterals;
-using LogSink = std::function<void(const QString&)>;
 
 // Qt's QtMsgType enum is NOT ordered by severity, so use this
 inline constexpr int severity(QtMsgType type) noexcept
@@ -50,80 +53,216 @@ inline constexpr int severity(QtMsgType type) noexcept
     return 0;
 }
 
-// To be safe, don't call this before Qt has finished app construction
+// To be safe, don't call this before Qt has finished app construction. Also
+// picks up log rules from the environment (see setLogRules)
 void init(
     bool verbose = false, // Coco::Bool?
     const Path& logDir = {},
     const QString& logPrefix = {},
     int logCap = 15);
 
+// Replaces the sink from the previous call (an Inline sink at every level).
+// Sinks from addLogSink are left alone
 void setLogSink(LogSink sink);
 QtMsgType minimumLevel() noexcept;
 
+inline bool isEnabled(const Category& category, QtMsgType type) noexcept
+{
+    return severity(type) >= category.floor();
+}
+
+inline bool isEnabled(QtMsgType type) noexcept
+{
+    return isEnabled(defaultCategory(), type);
+}
+
+// Clock behind each line's timestamp. Wall is the date and time to the
+// millisecond. Monotonic is the time since startup to the microsecond, which
+// never jumps and is cheaper to read (for high-rate logging). Set it once,
+// early: lines already queued are rendered with whatever is current
+enum class TimestampClock
+{
+    Wall,
+    Monotonic
+};
+
+void setTimestampClock(TimestampClock clock);
+
+// Now, in the current clock (nanoseconds since the epoch or since startup)
+qint64 timestampNow() noexcept;
+
+// Wall-clock boundaries for starting a new log file (on the same clock as the
+// file names and timestamps)
+enum class RotateEvery
+{
+    Never,
+    Hour,
+    Day
+};
+
+struct Rotation
+{
+    // Start a new file once the current one reaches this size (0 for no limit)
+    qint64 maxBytes = 0;
+    RotateEvery every = RotateEvery::Never;
+
+    // Closed files are qCompress'd in the background to "<name>.log.qz" (read
+    // them back with qUncompress)
+    bool compress = true;
+
+    // Oldest files (compressed or not) are pruned past this total, on top of
+    // init's logCap (0 for no limit)
+    qint64 budgetBytes = 0;
+};
+
+// Splits the log into segments. The new file is opened before the old one is
+// let go, and closing, compressing and pruning happen on Qt's global thread
+// pool, so writers never wait on any of it. Checked as lines are written, so a
+// time boundary with nothing logged across it rotates on the next line
+void setRotation(const Rotation& rotation);
+
+// What a producer does when the async queue is full
+enum class Overflow
+{
+    Block, // Wait for the writer to make room (nothing is lost)
+    DropOldest, // Evict the oldest queued record to make room
+    DropAndCount // Discard the new record
+};
+
+// Moves log file writes off the logging threads. Records are formatted by the
+// caller as before, then pushed into a bounded lock-free queue that a single
+// writer thread drains in batches (one flush per batch instead of per line).
+// Call after init. Capacity is rounded up to a power of two. Calling again
+// while already async does nothing
+void startAsync(int capacity = 8192, Overflow overflow = Overflow::Block);
+
+// Blocks until every record logged before the call has reached the log file
+// (and any Queued sinks), then flushes it. Fatal messages flush on their own;
+// call this before exiting or crashing on purpose. Fine to call in sync mode
+// (it just flushes the file)
+void flush();
+
+// Records lost to Overflow::DropOldest or Overflow::DropAndCount so far, plus
+// lines dropped by full Queued or Posted sinks
+quint64 droppedCount() noexcept;
+
+// Structured mode (async only). LOG calls stop formatting on the calling
+// thread: they capture the format, call site, timestamp and raw argument
+// values into a Record, and the writer thread renders it. Sinks and the
+// previous Qt handler are then called from the writer thread too. Fatal
+// messages always take the normal path. Has no effect until startAsync
+//
+// A literal format is captured by pointer. Runtime ones (a char* buffer, a
+// QString) are copied into the record, since they may not outlive it
+void setStructured(bool structured);
+bool isStructured() noexcept;
+
+// Default caps on rendering containers into log lines (and anywhere else
+// toQString is used without its own limits). Nothing is capped until this is
+// called. For example, to keep a 100k-entry map from stalling a log line:
+//
+// Debug::setRenderLimits({ .maxElements = 100, .maxDepth = 4 });
+void setRenderLimits(const RenderLimits& limits) noexcept;
+RenderLimits renderLimits() noexcept;
+
 struct Log
 {
     Log(QtMsgType type, const char* file, int line, const char* function)
-        : type(type)
+        : Log(defaultCategory(), type, file, line, function)
+    {
+    }
+
+    Log(const Category& category,
+        QtMsgType type,
+        const char* file,
+        int line,
+        const char* function)
+        : category(&category)
+        , type(type)
         , file(file)
         , line(line)
         , function(function)
     {
     }
 
+    const Category* category;
     QtMsgType type;
     const char* file;
     int line;
     const char* function;
 
     template <typename... Args>
-    inline void
-    print(const QObject* obj, QStringView format, Args&&... args) const
+    inline void print(
+        const QObject* obj,
+        Fmt::FormatString<Args...> format,
+        Args&&... args) const
     {
-        if (severity(type) < severity(minimumLevel()))
+        if (!enabled_(obj))
             return;
 
-        QString msg = sizeof...(Args) > 0
-                          ? Fmt::format(format, std::forward<Args>(args)...)
-                          : format.toString();
+        // Skips the UTF-8 decode too
+        if (type != QtFatalMsg && isStructured()) {
+            capture_(obj, format, std::forward<Args>(args)...);
+            return;
+        }
 
-        dispatch_(type, file, line, function, obj, std::move(msg));
+        // On the stack, unless it's long
+        Fmt::SmallString<> msg{};
+        Fmt::formatTo(msg, format, std::forward<Args>(args)...);
+        dispatch_(type, file, line, function, obj, msg.view());
     }
 
     template <typename... Args>
-    inline void print(QStringView format, Args&&... args) const
+    inline void print(Fmt::FormatString<Args...> format, Args&&... args) const
     {
-        return print(
+        print(
             static_cast<const QObject*>(nullptr),
             format,
             std::forward<Args>(args)...);
     }
 
-    template <typename... Args>
-    inline void
-    print(const QObject* obj, const char* format, Args&&... args) const
+private:
+    bool enabled_(const QObject* obj) const
     {
-        auto q_format = QString::fromUtf8(format);
-        print(obj, QStringView(q_format), std::forward<Args>(args)...);
+        if (obj && Internal::hasObjectLevels_.load(std::memory_order::relaxed))
+            return Internal::objectAllows_(obj, severity(type), *category);
+
+        return severity(type) >= category->floor();
     }
 
     template <typename... Args>
-    inline void print(const char* format, Args&&... args) const
+    inline void capture_(
+        const QObject* obj,
+        const Fmt::FormatString<Args...>& format,
+        Args&&... args) const
     {
-        auto q_format = QString::fromUtf8(format);
-        print(
-            static_cast<const QObject*>(nullptr),
-            QStringView(q_format),
-            std::forward<Args>(args)...);
+        Record record(type, file, line, function, obj);
+        record.category = category->name();
+        record.nsecs = timestampNow();
+
+        // Only a literal is sure to outlive the record; anything else is copied
+        if (format.isLiteral() && format.isUtf8())
+            record.setFormat(format.utf8());
+        else if (format.isUtf8())
+            record.setFormat(format.toString());
+        else
+            record.setFormat(format.utf16());
+
+        (record.append(std::forward<Args>(args)), ...);
+        submit_(record);
     }
 
-private:
+    // Hands the record to the writer (or renders and dispatches it, if async
+    // mode went away in the meantime)
+    void submit_(Record& record) const;
+
     void dispatch_(
         QtMsgType type,
         const char* file,
         int line,
         const char* function,
         const QObject* obj,
-        QString msg) const;
+        QStringView msg) const;
 };
 
 namespace Internal {
@@ -132,14 +271,9 @@ inline void assertionFailed_(
     const char* condition,
     const char* file,
     int line,
-    const char* function,
-    QStringView message = {})
+    const char* function)
 {
-    auto msg =
-        message.isEmpty()
-            ? Fmt::format(u"Assertion failed:\n{}"_s, condition)
-            : Fmt::format(u"Assertion failed:\n{}\n\n{}"_s, condition, message);
-
+    auto msg = Fmt::format(u"Assertion failed:\n{}", condition);
     Log(QtFatalMsg, file, line, function).print(msg);
 }
 
@@ -149,55 +283,77 @@ inline void assertionFailed_(
     const char* file,
     int line,
     const char* function,
-    QStringView format,
+    Fmt::FormatString<Args...> format,
     Args&&... args)
 {
     auto message = Fmt::format(format, std::forward<Args>(args)...);
-    assertionFailed_(condition, file, line, function, message);
-}
-
-// Message-only, const char*
-inline void assertionFailed_(
-    const char* condition,
-    const char* file,
-    int line,
-    const char* function,
-    const char* message)
-{
-    auto q_message = QString::fromUtf8(message);
-    assertionFailed_(condition, file, line, function, QStringView(q_message));
-}
-
-// Variadic, const char* format
-template <typename... Args>
-inline void assertionFailed_(
-    const char* condition,
-    const char* file,
-    int line,
-    const char* function,
-    const char* format,
-    Args&&... args)
-{
-    auto q_format = QString::fromUtf8(format);
-    assertionFailed_(
-        condition,
-        file,
-        line,
-        function,
-        QStringView(q_format),
-        std::forward<Args>(args)...);
+    auto msg = Fmt::format(u"Assertion failed:\n{}\n\n{}", condition, message);
+    Log(QtFatalMsg, file, line, function).print(msg);
 }
 
 } // namespace Internal
 
 } // namespace Coco::Debug
 
+// Compile-time floor, in severity() terms, from the COCO_MIN_LOG_LEVEL CMake
+// option. Levels below it compile to nothing: the call is still type-checked,
+// but its arguments are never evaluated. FATAL is never elided
+#ifndef COCO_MIN_LOG_LEVEL
+#    define COCO_MIN_LOG_LEVEL 0
+#endif
+
 #define LOG(Level)                                                             \
     Coco::Debug::Log(Level, __FILE__, __LINE__, __FUNCTION__).print
-#define DEBUG LOG(QtDebugMsg)
-#define INFO LOG(QtInfoMsg)
-#define WARN LOG(QtWarningMsg)
-#define CRITICAL LOG(QtCriticalMsg)
+
+#define CLOG(Category, Level)                                                  \
+    Coco::Debug::Log(Category, Level, __FILE__, __LINE__, __FUNCTION__).print
+
+// Runtime level check first, so a disabled level skips argument evaluation too.
+// The gate is one relaxed load off the category the call site already holds
+#define COCO_LOG_(Category, Level, ...)                                        \
+    (Coco::Debug::severity(Level) < (Category).gate()                          \
+         ? static_cast<void>(0)                                                \
+         : CLOG(Category, Level)(__VA_ARGS__))
+
+// Unevaluated operand: no code, no side effects, but still type-checked (and
+// still "uses" its variables, so no unused warnings in release)
+#define COCO_LOG_ELIDED_(Category, Level, ...)                                 \
+    static_cast<void>(sizeof(decltype(CLOG(Category, Level)(__VA_ARGS__))*))
+
+#if COCO_MIN_LOG_LEVEL > 0
+#    define CDEBUG(Category, ...)                                              \
+        COCO_LOG_ELIDED_(Category, QtDebugMsg, __VA_ARGS__)
+#else
+#    define CDEBUG(Category, ...) COCO_LOG_(Category, QtDebugMsg, __VA_ARGS__)
+#endif
+
+#if COCO_MIN_LOG_LEVEL > 1
+#    define CINFO(Category, ...)                                               \
+        COCO_LOG_ELIDED_(Category, QtInfoMsg, __VA_ARGS__)
+#else
+#    define CINFO(Category, ...) COCO_LOG_(Category, QtInfoMsg, __VA_ARGS__)
+#endif
+
+#if COCO_MIN_LOG_LEVEL > 2
+#    define CWARN(Category, ...)                                               \
+        COCO_LOG_ELIDED_(Category, QtWarningMsg, __VA_ARGS__)
+#else
+#    define CWARN(Category, ...) COCO_LOG_(Category, QtWarningMsg, __VA_ARGS__)
+#endif
+
+#if COCO_MIN_LOG_LEVEL > 3
+#    define CCRITICAL(Category, ...)                                           \
+        COCO_LOG_ELIDED_(Category, QtCriticalMsg, __VA_ARGS__)
+#else
+#    define CCRITICAL(Category, ...)                                           \
+        COCO_LOG_(Category, QtCriticalMsg, __VA_ARGS__)
+#endif
+
+#define DEBUG(...) CDEBUG(Coco::Debug::defaultCategory(), __VA_ARGS__)
+#define INFO(...) CINFO(Coco::Debug::defaultCategory(), __VA_ARGS__)
+#define WARN(...) CWARN(Coco::Debug::defaultCategory(), __VA_ARGS__)
+#define CRITICAL(...) CCRITICAL(Coco::Debug::defaultCategory(), __VA_ARGS__)
+
 #define FATAL LOG(QtFatalMsg)
 
 #define TRACER DEBUG(__FUNCTION__)
@@ -0,0 +1,82 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QtTypes>
+
+#include "Coco/Path.h"
+
+namespace Coco {
+
+class StatCache;
+
+namespace Internal {
+
+struct ListedEntry;
+
+} // namespace Internal
+
+// A listed path plus what the listing learned about it, so asking again costs
+// nothing. The type comes free with the listing (a symlink takes its target's
+// type, as with QFileInfo); size, mtime and permissions are there only when
+// the walk stat'ed (see hasStat)
+class DirEntry
+{
+public:
+    DirEntry() = default;
+
+    const Path& path() const noexcept { return path_; }
+
+    bool exists() const noexcept { return exists_; }
+    bool isFile() const noexcept { return isFile_; }
+    bool isDir() const noexcept { return isDir_; }
+    bool isSymLink() const noexcept { return isSymLink_; }
+    bool isHidden() const noexcept { return isHidden_; }
+
+    // With WalkOptions::stat, or from dirEntries()
+    bool hasStat() const noexcept { return hasStat_; }
+
+    // -1 without stat data
+    qint64 size() const noexcept { return size_; }
+
+    // Invalid without stat data
+    QDateTime lastModified() const
+    {
+        return hasStat_ ? QDateTime::fromMSecsSinceEpoch(modified_)
+                        : QDateTime{};
+    }
+
+    QFile::Permissions permissions() const noexcept { return permissions_; }
+
+private:
+    friend class StatCache;
+    friend struct Internal::ListedEntry;
+
+    Path path_{};
+    bool exists_ = false;
+    bool isFile_ = false;
+    bool isDir_ = false;
+    bool isSymLink_ = false;
+    bool isHidden_ = false;
+    bool hasStat_ = false;
+    qint64 size_ = -1;
+    qint64 modified_ = 0;
+    QFile::Permissions permissions_{};
+};
+
+using DirEntryList = QList<DirEntry>;
+
+} // namespace Coco
@@ -12,37 +12,88 @@
 
 #pragma once
 
+#include <algorithm>
+
+#include <QDir>
 #include <QString>
 #include <QStringList>
+#include <QtTypes>
 
+#include "Coco/DirEntry.h"
 #include "Coco/Path.h"
+#include "Coco/Walk.h"
 
 namespace Coco::Disk {
 
-inline void
-prune(const Path& dir, const QString& prefix, const QString& ext, int cap)
+// Deletes the oldest files in dir whose names start with prefix and end with
+// one of exts, until at most cap are left (if cap > 0) and they take up at most
+// maxBytes in total (if maxBytes > 0). "Oldest" is by name, so this is meant
+// for timestamped names. The newest file is always kept, even if it alone is
+// over the budget
+inline void prune(
+    const Path& dir,
+    const QString& prefix,
+    const QStringList& exts,
+    int cap,
+    qint64 maxBytes = 0)
 {
-    if (cap < 1)
+    if (cap < 1 && maxBytes < 1)
         return;
 
-    auto all_files = filePaths(dir);
-    QStringList matches{};
+    // Sizes come with the listing, so nothing is stat'ed twice
+    DirEntryList matches{};
+
+    for (auto& entry : dirEntries(dir, QDir::Files)) {
+        auto name = entry.path().nameView();
+        if (!name.startsWith(prefix))
+            continue;
 
-    for (auto& path : all_files) {
-        auto name = path.nameQString();
-        if (name.startsWith(prefix) && name.endsWith(ext))
-            matches << name;
+        for (auto& ext : exts) {
+            if (name.endsWith(ext)) {
+                matches << entry;
+                break;
+            }
+        }
     }
 
-    if (matches.size() <= cap)
+    if (matches.size() < 2)
         return;
 
-    matches.sort();
+    std::sort(
+        matches.begin(),
+        matches.end(),
+        [](const DirEntry& a, const DirEntry& b) {
+            return a.path().nameView() < b.path().nameView();
+        });
+
+    // Walk newest to oldest, keeping files until one of the limits is hit
+    qsizetype keep = 1;
+    auto total = matches.last().size();
+
+    for (; keep < matches.size(); ++keep) {
+        if (cap > 0 && keep >= cap)
+            break;
+
+        total += matches[matches.size() - 1 - keep].size();
 
-    auto to_remove = matches.size() - cap;
+        if (maxBytes > 0 && total > maxBytes)
+            break;
+    }
+
+    auto to_remove = matches.size() - keep;
 
     for (qsizetype i = 0; i < to_remove; ++i)
-        remove(dir / matches[i]);
+        remove(matches[i].path());
+}
+
+inline void prune(
+    const Path& dir,
+    const QString& prefix,
+    const QString& ext,
+    int cap,
+    qint64 maxBytes = 0)
+{
+    prune(dir, prefix, QStringList{ ext }, cap, maxBytes);
 }
 
 } // namespace Coco::Disk
@@ -0,0 +1,176 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <shared_mutex>
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+#include "Coco/Path.h"
+
+// A live, in-memory index of the files under a set of roots, in place of
+// rescanning them to notice changes. Built with one parallel scan, then kept
+// current one directory at a time: a change re-lists only the directory it
+// happened in (new subdirectories are walked, removed ones dropped whole), so
+// keeping up costs nothing like the tree's size
+//
+// On Linux, changes come straight from inotify (one watch per directory, so
+// mind fs.inotify.max_user_watches for huge trees). Elsewhere, from a
+// QFileSystemWatcher. If events are lost (inotify's queue overflowing), the
+// index resyncs itself
+//
+// Files are filtered as Coco::scan filters them with QDir::Files (exts globs,
+// case-insensitive). Queries are safe from any thread; the index updates, and
+// emits, on its own:
+//
+// Coco::FileIndex index({ project }, { .exts = { "*.cpp", "*.h" } });
+// connect(&index, &Coco::FileIndex::filesAdded, this, &Model::add);
+//
+// auto headers = index.withExtension(u".h");
+// auto tests = index.subtree(project / "tests");
+namespace Coco {
+
+namespace Internal {
+
+class EntryFilter;
+
+} // namespace Internal
+
+struct FileIndexOptions
+{
+    // Provide extensions as: `{ "*.mp3", "*.wav" }`
+    QStringList exts{};
+
+    // Index hidden files, and look inside hidden directories
+    bool hidden = false;
+
+    // For the initial scan (0 for one per core)
+    int threads = 0;
+};
+
+class FileIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileIndex(
+        const PathList& roots,
+        const FileIndexOptions& options = {},
+        QObject* parent = nullptr);
+
+    virtual ~FileIndex() override;
+
+    PathList roots() const { return roots_; }
+    qsizetype size() const;
+    bool contains(const Path& path) const;
+
+    // Sorted by path
+    PathList files() const;
+
+    // Takes ".ext" or "ext", matched case-insensitively
+    PathList withExtension(QStringView ext) const;
+
+    // Paths starting with prefix, as text ("src/ui" finds "src/ui.cpp" and
+    // "src/ui/view.h")
+    PathList withPrefix(QStringView prefix) const;
+
+    // Everything below dir
+    PathList subtree(const Path& dir) const;
+
+    // Rescans every root, emitting whatever changed since the index last
+    // knew. Only needed if changes could have been missed (a root replaced
+    // outright, say)
+    void resync();
+
+signals:
+    // Batched, as each round of changes is applied
+    void filesAdded(const Coco::PathList& paths);
+    void filesRemoved(const Coco::PathList& paths);
+
+private:
+    // What the index knows of one directory, by name
+    struct Dir_
+    {
+        QSet<QString> files{};
+        QSet<QString> subdirs{};
+        int watch = -1; // inotify watch descriptor
+    };
+
+    // Indexed paths, sorted (for prefixes) and by extension
+    struct Files_
+    {
+        std::set<QString> paths{};
+        QHash<QString, QSet<QString>> byExt{};
+
+        // False if already there (or, for erase, not there)
+        bool insert(const QString& path);
+        bool erase(const QString& path);
+    };
+
+    PathList roots_{};
+    FileIndexOptions options_;
+    std::unique_ptr<Internal::EntryFilter> filter_;
+
+    mutable std::shared_mutex mutex_{};
+    Files_ files_{};
+
+    // Touched only on the index's thread
+    QHash<QString, Dir_> dirs_{};
+
+    // Where files go while resync builds a new index aside (null otherwise)
+    Files_* staging_ = nullptr;
+    PathList added_{};
+    PathList removed_{};
+
+#ifdef Q_OS_LINUX
+    int inotify_ = -1;
+    QSocketNotifier* notifier_ = nullptr;
+
+    // Directories by watch. The kernel keeps one watch per inode, so a
+    // directory moved within the index shares its watch with its old path
+    // until that's dropped
+    QHash<int, QSet<QString>> watches_{};
+#else
+    QFileSystemWatcher* watcher_ = nullptr;
+#endif
+
+    void build_();
+    void clear_();
+    void addDir_(const QString& dir, int watch = -1);
+    void addTree_(const QString& dir);
+    void removeDir_(const QString& dir);
+    void addFile_(const QString& path);
+    void removeFile_(const QString& path);
+    void syncDir_(const QString& dir);
+    void flush_();
+    void watch_(const QString& dir, Dir_& node, int watch = -1);
+    void unwatch_(Dir_& node, const QString& dir);
+
+#ifdef Q_OS_LINUX
+    int addWatch_(const QString& dir) const;
+    void readInotify_();
+#endif
+
+    static QString extKey_(const QString& path);
+};
+
+} // namespace Coco
@@ -12,35 +12,508 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #include <QChar>
 #include <QLatin1StringView>
 #include <QString>
 #include <QStringView>
+#include <QVarLengthArray>
+#include <QtTypes>
 
+#include "Coco/Simd.h"
 #include "Coco/ToQString.h"
 
 namespace Coco::Fmt {
 
 using namespace Qt::StringLiterals;
 
+// Defers an expensive argument until the message is actually formatted:
+//
+// DEBUG("model: {}", Fmt::lazy([&] { return dump(model); }));
+//
+// The logging macros already skip their arguments when the level is off, so
+// this matters where formatting can still be skipped later (a direct
+// LOG(Level) call, for one). Structured log records evaluate it at capture,
+// since the callable may hold references that won't outlive the call
+template <typename FnT> struct Lazy
+{
+    FnT fn;
+};
+
+template <typename FnT> inline Lazy<std::decay_t<FnT>> lazy(FnT&& fn)
+{
+    return { std::forward<FnT>(fn) };
+}
+
+// A string that keeps its first N UTF-16 units on the stack, for formatTo when
+// the text is only needed briefly (as a view) and is usually short. Past N it
+// moves to the heap, like the QVarLengthArray it wraps:
+//
+// Fmt::SmallString<> line{};
+// Fmt::formatTo(line, "{} of {} files", done, total);
+// stream << line.view();
+template <qsizetype N = 256> class SmallString
+{
+public:
+    qsizetype size() const noexcept { return data_.size(); }
+    bool isEmpty() const noexcept { return data_.isEmpty(); }
+
+    QStringView view() const noexcept
+    {
+        return QStringView(data_.constData(), data_.size());
+    }
+
+    QString toString() const { return view().toString(); }
+
+    // Keeps the capacity, so a reused SmallString stops reallocating once it's
+    // grown to fit
+    void clear() { data_.clear(); }
+    void reserve(qsizetype size) { data_.reserve(size); }
+
+    void append(QStringView text) { data_.append(text.utf16(), text.size()); }
+    void append(char16_t ch) { data_.append(ch); }
+
+    void append(QLatin1StringView text)
+    {
+        auto old_size = data_.size();
+        data_.resize(old_size + text.size());
+
+        for (qsizetype i = 0; i < text.size(); ++i)
+            data_[old_size + i] = static_cast<unsigned char>(text.data()[i]);
+    }
+
+    void appendFill(qsizetype count, char16_t ch)
+    {
+        auto old_size = data_.size();
+        data_.resize(old_size + count);
+        std::fill(data_.begin() + old_size, data_.end(), ch);
+    }
+
+private:
+    QVarLengthArray<char16_t, N> data_{};
+};
+
 namespace Internal {
 
+// A replacement field's spec, after the ':' in {:...}:
+//
+//   [[fill]align][sign][#][0][width][.precision][type]
+//
+// As in std::format, minus nested (argument-supplied) width and precision.
+// Types are b, B, d, o, x, X (integers), e, E, f, F, g, G (floats) and s. A
+// type that doesn't fit the argument is ignored, except that float types
+// format integers as floats
+struct Spec_
+{
+    char16_t fill = u' ';
+
+    // '<', '>' or '^' (0 for the default: right for numbers, left for text)
+    char align = 0;
+
+    // '+' or ' ' ('-' is the default, so it's stored as 0)
+    char sign = 0;
+
+    bool alternate = false;
+    bool zero = false;
+    quint16 width = 0;
+    qint16 precision = -1;
+    char type = 0;
+
+    constexpr bool isEmpty() const noexcept
+    {
+        return width == 0 && precision < 0 && type == 0 && sign == 0 &&
+               !alternate;
+    }
+};
+
+inline constexpr auto MAX_SPEC_NUMBER_ = 0x7FFF;
+
+// Parses a spec starting at pos (just past the ':'). Returns the index of the
+// closing '}', or -1 if the spec is malformed (in which case the walkers treat
+// the braces as literal text, same as any other malformed field)
+template <typename CharT>
+constexpr qsizetype
+parseSpec_(const CharT* data, qsizetype size, qsizetype pos, Spec_& spec)
+{
+    auto at = [&](qsizetype i) {
+        return i < size ? char16_t(data[i]) : char16_t{};
+    };
+
+    auto is_align = [](char16_t ch) {
+        return ch == u'<' || ch == u'>' || ch == u'^';
+    };
+
+    auto is_digit = [](char16_t ch) { return ch >= u'0' && ch <= u'9'; };
+
+    auto number = [&](int& value) {
+        value = 0;
+
+        while (is_digit(at(pos))) {
+            value = value * 10 + (at(pos) - u'0');
+            if (value > MAX_SPEC_NUMBER_)
+                return false;
+
+            ++pos;
+        }
+
+        return true;
+    };
+
+    if (pos < size && at(pos) != u'{' && at(pos) != u'}' &&
+        is_align(at(pos + 1))) {
+        spec.fill = at(pos);
+        spec.align = char(at(pos + 1));
+        pos += 2;
+    } else if (is_align(at(pos))) {
+        spec.align = char(at(pos));
+        ++pos;
+    }
+
+    if (at(pos) == u'+' || at(pos) == u' ') {
+        spec.sign = char(at(pos));
+        ++pos;
+    } else if (at(pos) == u'-') {
+        ++pos;
+    }
+
+    if (at(pos) == u'#') {
+        spec.alternate = true;
+        ++pos;
+    }
+
+    if (at(pos) == u'0') {
+        spec.zero = true;
+        ++pos;
+    }
+
+    auto width = 0;
+    if (!number(width))
+        return -1;
+
+    spec.width = quint16(width);
+
+    if (at(pos) == u'.') {
+        ++pos;
+
+        auto precision = 0;
+        if (!is_digit(at(pos)) || !number(precision))
+            return -1;
+
+        spec.precision = qint16(precision);
+    }
+
+    for (auto type : u"bBdoxXeEfFgGs") {
+        if (type && at(pos) == type) {
+            spec.type = char(type);
+            ++pos;
+            break;
+        }
+    }
+
+    return at(pos) == u'}' ? pos : -1;
+}
+
+// What formatTo writes to: a QString, or anything with the same appends plus
+// appendFill (for padding), like SmallString
+template <typename T>
+concept Output_ = std::same_as<T, QString> ||
+                  requires(
+                      T& out,
+                      QStringView text,
+                      QLatin1StringView latin1,
+                      char16_t ch,
+                      qsizetype n) {
+                      out.append(text);
+                      out.append(latin1);
+                      out.append(ch);
+                      out.appendFill(n, ch);
+                      out.reserve(n);
+                      { out.size() } -> std::convertible_to<qsizetype>;
+                  };
+
+// Output that only counts, for exact sizing (see Fmt::formattedSize)
+struct Counter_
+{
+    qsizetype count = 0;
+
+    qsizetype size() const noexcept { return count; }
+    void reserve(qsizetype) noexcept {}
+    void append(QStringView text) noexcept { count += text.size(); }
+    void append(QLatin1StringView text) noexcept { count += text.size(); }
+    void append(char16_t) noexcept { ++count; }
+    void appendFill(qsizetype n, char16_t) noexcept { count += n; }
+};
+
+template <typename OutT>
+inline void pad_(OutT& out, qsizetype count, char16_t fill)
+{
+    if (count < 1)
+        return;
+
+    if constexpr (std::same_as<OutT, QString>)
+        out.resize(out.size() + count, QChar(fill));
+    else
+        out.appendFill(count, fill);
+}
+
+// Pads whatever append adds (length characters) out to the spec's width
+template <typename OutT, typename AppendT>
+inline void appendAligned_(
+    OutT& out,
+    const Spec_& spec,
+    qsizetype length,
+    char defaultAlign,
+    AppendT append)
+{
+    auto padding = qMax(spec.width - length, qsizetype(0));
+    auto align = spec.align ? spec.align : defaultAlign;
+    auto before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+
+    pad_(out, before, spec.fill);
+    append();
+    pad_(out, padding - before, spec.fill);
+}
+
+// Zero padding goes between the sign (or base prefix) and the digits, and only
+// applies without an explicit alignment
+template <typename OutT>
+inline void appendNumber_(
+    OutT& out,
+    const Spec_& spec,
+    QLatin1StringView prefix,
+    QLatin1StringView digits)
+{
+    auto length = prefix.size() + digits.size();
+
+    if (spec.zero && !spec.align) {
+        out.append(prefix);
+        pad_(out, spec.width - length, u'0');
+        out.append(digits);
+        return;
+    }
+
+    appendAligned_(out, spec, length, '>', [&] {
+        out.append(prefix);
+        out.append(digits);
+    });
+}
+
+template <typename OutT>
+inline void appendText_(OutT& out, const Spec_& spec, QStringView text)
+{
+    if (spec.precision >= 0 && spec.precision < text.size())
+        text = text.first(spec.precision);
+
+    appendAligned_(out, spec, text.size(), '<', [&] { out.append(text); });
+}
+
+// Without a type or precision, the shortest text that reads back as the same
+// float or double (as in std::format). QString::number would round to 6
+// digits instead
+template <typename OutT, std::floating_point T>
+inline void appendFloat_(OutT& out, const Spec_& spec, T value)
+{
+    auto format = std::chars_format::general;
+
+    // Only float types count (an integer or string type is ignored)
+    auto typed = true;
+
+    switch (spec.type) {
+    case 'e':
+    case 'E':
+        format = std::chars_format::scientific;
+        break;
+    case 'f':
+    case 'F':
+        format = std::chars_format::fixed;
+        break;
+    case 'g':
+    case 'G':
+        break;
+    default:
+        typed = false;
+        break;
+    }
+
+    auto shortest = !typed && spec.precision < 0;
+
+    auto precision = spec.precision < 0 ? 6 : int(spec.precision);
+
+    // Enough for any value at this precision. Fixed notation can need every
+    // integer digit (309 for a double); the others, a few past the precision.
+    // Only long fixed precisions leave the stack
+    constexpr auto STACK_SIZE = 384;
+    auto digits = format == std::chars_format::fixed
+                      ? std::numeric_limits<T>::max_exponent10 + 1
+                      : 0;
+    auto size = 32 + digits + precision;
+    char stack[STACK_SIZE];
+    std::unique_ptr<char[]> heap{};
+    auto first = stack;
+
+    if (size > STACK_SIZE) {
+        heap = std::make_unique_for_overwrite<char[]>(size);
+        first = heap.get();
+    }
+
+    auto last = shortest ? std::to_chars(first, first + size, value).ptr
+                         : std::to_chars(
+                               first,
+                               first + size,
+                               value,
+                               format,
+                               precision)
+                               .ptr;
+
+    if (spec.type == 'E' || spec.type == 'F' || spec.type == 'G')
+        for (auto it = first; it != last; ++it)
+            if (*it >= 'a' && *it <= 'z')
+                *it -= 'a' - 'A';
+
+    char sign[1]{};
+    qsizetype sign_size = 0;
+
+    if (*first == '-') {
+        sign[sign_size++] = '-';
+        ++first;
+    } else if (spec.sign) {
+        sign[sign_size++] = spec.sign;
+    }
+
+    auto number_spec = spec;
+    number_spec.zero = spec.zero && std::isfinite(value);
+
+    appendNumber_(
+        out,
+        number_spec,
+        QLatin1StringView(sign, sign_size),
+        QLatin1StringView(first, last - first));
+}
+
+template <typename OutT>
+inline void appendInteger_(
+    OutT& out,
+    const Spec_& spec,
+    quint64 magnitude,
+    bool negative)
+{
+    auto base = 10;
+    const char* base_prefix = "";
+
+    switch (spec.type) {
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G': {
+        auto value = static_cast<double>(magnitude);
+        appendFloat_(out, spec, negative ? -value : value);
+        return;
+    }
+    case 'b':
+        base = 2;
+        base_prefix = "0b";
+        break;
+    case 'B':
+        base = 2;
+        base_prefix = "0B";
+        break;
+    case 'o':
+        base = 8;
+        base_prefix = magnitude ? "0" : "";
+        break;
+    case 'x':
+        base = 16;
+        base_prefix = "0x";
+        break;
+    case 'X':
+        base = 16;
+        base_prefix = "0X";
+        break;
+    default:
+        break;
+    }
+
+    // Sign plus the longest base prefix
+    char prefix[3]{};
+    qsizetype prefix_size = 0;
+
+    if (negative)
+        prefix[prefix_size++] = '-';
+    else if (spec.sign)
+        prefix[prefix_size++] = spec.sign;
+
+    if (spec.alternate)
+        for (auto it = base_prefix; *it; ++it)
+            prefix[prefix_size++] = *it;
+
+    // 64 binary digits at most
+    char digits[64];
+    auto last = std::to_chars(digits, digits + 64, magnitude, base).ptr;
+
+    if (spec.type == 'X')
+        for (auto it = digits; it != last; ++it)
+            if (*it >= 'a' && *it <= 'f')
+                *it -= 'a' - 'A';
+
+    appendNumber_(
+        out,
+        spec,
+        QLatin1StringView(prefix, prefix_size),
+        QLatin1StringView(digits, last - digits));
+}
+
+// Longest default-formatted number: a shortest round-trip double, like
+// -2.2250738585072014e-308 (the longest integer, INT64_MIN, is 20)
+inline constexpr qsizetype SCRATCH_SIZE_ = 24;
+
 // Per-arg wrapper that either borrows (QString/QStringView paths, zero
-// alloc) or owns (fallback path, one alloc via toQString). `view` is the
-// canonical appendable form. `owned` is the backing store when we have to
-// materialize one
+// alloc), owns (fallback path, one alloc via toQString), or holds a number
+// (no alloc either). `view` is the canonical appendable form. `owned` is the
+// backing store when we have to materialize one, and `scratch` holds a
+// number's default text, written by to_chars when the arg is made. A {:spec}
+// formats the raw number instead
 //
 // Non-movable and non-copyable. `view` may point into this object's own
-// `owned` member, so relocation would invalidate it. Elements are
+// `owned` or `scratch` member, so relocation would invalidate it. Elements are
 // constructed in place in the std::array below via braced aggregate init,
 // which is guaranteed to avoid copies/moves in C++20
 struct ArgView_
 {
+    enum class Kind : quint8
+    {
+        Text,
+        Int,
+        UInt,
+        Float,
+        Double
+    };
+
     QStringView view;
     QString owned;
+    Kind kind = Kind::Text;
+
+    union
+    {
+        qint64 i;
+        quint64 u;
+        float f;
+        double d;
+    } number{};
+
+    char16_t scratch[SCRATCH_SIZE_];
 
     ArgView_() = default;
 
@@ -55,13 +528,86 @@ struct ArgView_
         view = owned;
     }
 
+    explicit ArgView_(qint64 value) { setInt(value); }
+    explicit ArgView_(quint64 value) { setUInt(value); }
+    explicit ArgView_(float value) { setFloat(value); }
+    explicit ArgView_(double value) { setDouble(value); }
+
     ArgView_(const ArgView_&) = delete;
     ArgView_& operator=(const ArgView_&) = delete;
     ArgView_(ArgView_&&) = delete;
     ArgView_& operator=(ArgView_&&) = delete;
 
+    void setInt(qint64 value)
+    {
+        kind = Kind::Int;
+        number.i = value;
+        fillScratch_(value);
+    }
+
+    void setUInt(quint64 value)
+    {
+        kind = Kind::UInt;
+        number.u = value;
+        fillScratch_(value);
+    }
+
+    void setFloat(float value)
+    {
+        kind = Kind::Float;
+        number.f = value;
+        fillScratch_(value);
+    }
+
+    void setDouble(double value)
+    {
+        kind = Kind::Double;
+        number.d = value;
+        fillScratch_(value);
+    }
+
+    // Exact, numbers included (as long as the field has no spec)
     qsizetype size() const noexcept { return view.size(); }
-    void appendTo(QString& out) const { out.append(view); }
+
+    template <typename OutT>
+    void appendTo(OutT& out, const Spec_& spec = {}) const
+    {
+        if (spec.isEmpty()) {
+            out.append(view);
+            return;
+        }
+
+        switch (kind) {
+        case Kind::Text:
+            appendText_(out, spec, view);
+            break;
+        case Kind::Int: {
+            auto negative = number.i < 0;
+            auto magnitude =
+                negative ? 0 - quint64(number.i) : quint64(number.i);
+            appendInteger_(out, spec, magnitude, negative);
+            break;
+        }
+        case Kind::UInt:
+            appendInteger_(out, spec, number.u, false);
+            break;
+        case Kind::Float:
+            appendFloat_(out, spec, number.f);
+            break;
+        case Kind::Double:
+            appendFloat_(out, spec, number.d);
+            break;
+        }
+    }
+
+private:
+    template <typename T> void fillScratch_(T value)
+    {
+        char narrow[SCRATCH_SIZE_];
+        auto last = std::to_chars(narrow, narrow + SCRATCH_SIZE_, value).ptr;
+        std::copy(narrow, last, scratch);
+        view = QStringView(scratch, last - narrow);
+    }
 };
 
 // --- Borrowing builders (zero-alloc) ---
@@ -77,14 +623,72 @@ inline ArgView_ makeArg_(const char* s)
     return ArgView_(QString::fromUtf8(s));
 }
 
-// Generic fallback (anything ToQString.h knows how to handle)
+// --- Numbers (no alloc, formatted into the arg's scratch) ---
+
+// Same set toQString formats with QString::number
+template <typename T>
+    requires std::integral<std::remove_cvref_t<T>> &&
+             (!std::same_as<std::remove_cvref_t<T>, bool>) &&
+             (!std::same_as<std::remove_cvref_t<T>, char>)
+inline ArgView_ makeArg_(T&& value)
+{
+    if constexpr (std::is_signed_v<std::remove_cvref_t<T>>)
+        return ArgView_(static_cast<qint64>(value));
+    else
+        return ArgView_(static_cast<quint64>(value));
+}
+
+// Floats keep their own shortest form (0.1f, not 0.10000000149011612)
+template <typename T>
+    requires std::floating_point<std::remove_cvref_t<T>>
+inline ArgView_ makeArg_(T&& value)
+{
+    if constexpr (std::same_as<std::remove_cvref_t<T>, float>)
+        return ArgView_(static_cast<float>(value));
+    else
+        return ArgView_(static_cast<double>(value));
+}
+
+// Generic fallback (anything ToQString.h knows how to handle). Written
+// straight into the arg's own string, or through a caller's toQString overload
+// for types appendQString doesn't know
 template <typename T> inline ArgView_ makeArg_(T&& value)
 {
-    return ArgView_(toQString(std::forward<T>(value)));
+    if constexpr (AppendsToQString<std::remove_cvref_t<T>>) {
+        QString text{};
+        appendQString(text, value);
+        return ArgView_(std::move(text));
+    } else {
+        return ArgView_(toQString(std::forward<T>(value)));
+    }
+}
+
+template <typename T> struct IsLazy_ : std::false_type
+{
+};
+
+template <typename FnT> struct IsLazy_<Lazy<FnT>> : std::true_type
+{
+};
+
+// Lazy args are only evaluated here, once formatting is actually happening
+template <typename T>
+    requires IsLazy_<std::remove_cvref_t<T>>::value
+inline ArgView_ makeArg_(T&& value)
+{
+    using ResultT = std::remove_cvref_t<decltype(value.fn())>;
+
+    // Forwarded, so a lazy number is still a number (specs apply). Text is
+    // copied rather than borrowed: what fn returned is gone after this
+    if constexpr (
+        std::same_as<ResultT, QString> || std::same_as<ResultT, QStringView>)
+        return ArgView_(toQString(value.fn()));
+    else
+        return makeArg_(value.fn());
 }
 
 // Expand each arg to an ArgView_. QString/QStringView args take the
-// zero-alloc path (everything else routes through toQString)
+// zero-alloc path (everything else routes through appendQString)
 template <typename... Args>
 inline std::array<ArgView_, sizeof...(Args)> expand_(Args&&... args)
 {
@@ -104,31 +708,35 @@ estimateSize_(QStringView tmpl, const ArgView_* values, qsizetype count)
     return total;
 }
 
-// Single-pass walker. Copies literal runs in bulk via append(QStringView)
-// and substitutes args at each {}. Supports {{ and }} as literal braces
-inline QString
-format_(QStringView tmpl, const ArgView_* values, qsizetype count)
+// Single-pass walker. Jumps brace to brace (Simd::findEither), copying the
+// literal runs between them in bulk, and substitutes args at each {} or
+// {:spec}. Supports {{ and }} as literal braces. Appends to out, without
+// reserving
+template <typename OutT>
+inline void formatTo_(
+    OutT& out,
+    QStringView tmpl,
+    const ArgView_* values,
+    qsizetype count)
 {
-    QString out{};
-    out.reserve(estimateSize_(tmpl, values, count));
-
-    auto data = tmpl.constData();
+    auto data = tmpl.utf16();
     auto size = tmpl.size();
     qsizetype run_start = 0;
     qsizetype next_arg = 0;
     qsizetype i = 0;
 
-    while (i < size) {
-        auto ch = data[i];
-
-        if (ch == u'{') {
-            // Flush the literal run before the brace
-            if (i > run_start) {
-                out.append(QStringView(data + run_start, i - run_start));
-            }
+    // Flush the literal run before position i
+    auto flush = [&] {
+        if (i > run_start) {
+            out.append(QStringView(data + run_start, i - run_start));
+        }
+    };
 
+    while ((i = Simd::findEither(data, size, i, u'{', u'}')) < size) {
+        if (data[i] == u'{') {
             // Escaped '{{' -> literal '{'
             if (i + 1 < size && data[i + 1] == u'{') {
+                flush();
                 out.append(u'{');
                 i += 2;
                 run_start = i;
@@ -136,17 +744,27 @@ format_(QStringView tmpl, const ArgView_* values, qsizetype count)
                 continue;
             }
 
-            // Substitution '{}' (anything else is malformed, and we treat a
-            // lone '{' as a literal)
-            if (i + 1 < size && data[i + 1] == u'}') {
+            // Substitution '{}' or '{:spec}' (anything else is malformed, and
+            // we treat a lone '{' as a literal)
+            Spec_ spec{};
+            qsizetype end = -1;
+
+            if (i + 1 < size && data[i + 1] == u'}')
+                end = i + 1;
+            else if (i + 1 < size && data[i + 1] == u':')
+                end = parseSpec_(data, size, i + 2, spec);
+
+            if (end > i) {
+                flush();
+
                 if (next_arg < count) {
-                    values[next_arg].appendTo(out);
+                    values[next_arg].appendTo(out, spec);
                     ++next_arg;
                 }
 
-                // If we're out of args, the '{}' is silently dropped
+                // If we're out of args, the field is silently dropped
 
-                i += 2;
+                i = end + 1;
                 run_start = i;
 
                 continue;
@@ -157,43 +775,338 @@ format_(QStringView tmpl, const ArgView_* values, qsizetype count)
             continue;
         }
 
-        if (ch == u'}') {
-            // Only '}}' is meaningful outside a substitution (a lone '}' is
-            // treated as literal)
-            if (i + 1 < size && data[i + 1] == u'}') {
-                if (i > run_start) {
-                    out.append(QStringView(data + run_start, i - run_start));
-                }
+        // Only '}}' is meaningful outside a substitution (a lone '}' is
+        // treated as literal)
+        if (i + 1 < size && data[i + 1] == u'}') {
+            flush();
+            out.append(u'}');
+            i += 2;
+            run_start = i;
+
+            continue;
+        }
+
+        ++i;
+    }
+
+    // Flush trailing literal (findEither leaves i at size)
+    flush();
+}
+
+inline QString
+format_(QStringView tmpl, const ArgView_* values, qsizetype count)
+{
+    QString out{};
+    out.reserve(estimateSize_(tmpl, values, count));
+    formatTo_(out, tmpl, values, count);
+
+    return out;
+}
+
+// A literal run of the template, or (begin == ARG_SLOT_) an argument and its
+// spec
+struct Segment_
+{
+    quint16 begin = 0;
+    quint16 size = 0;
+    Spec_ spec{};
+};
+
+inline constexpr quint16 ARG_SLOT_ = 0xFFFF;
+
+// Room for every literal run and slot, plus a few escapes. Templates that need
+// more (or are longer than a Segment_ can index) use the runtime walker
+inline constexpr std::size_t ESCAPE_SLACK_ = 4;
+
+// Deliberately not constexpr: reaching it during constant evaluation is what
+// turns a mismatch into a compile error (and its name into the message)
+inline void placeholderCountDoesNotMatchArgumentCount_() {}
+
+// See Fmt::FormatString
+template <typename... Args> class FormatString_
+{
+public:
+    template <std::size_t N>
+    consteval FormatString_(const char16_t (&tmpl)[N])
+        : utf16_(tmpl, qsizetype(N - 1))
+        , literal_(true)
+    {
+        parse_(tmpl, N - 1);
+    }
+
+    // Literal runs are appended as Latin-1, which only agrees with UTF-8 for
+    // ASCII. Anything else is still checked here, but decoded and walked at
+    // runtime
+    template <std::size_t N>
+    consteval FormatString_(const char (&tmpl)[N])
+        : utf8_(tmpl)
+        , utf8Size_(qsizetype(N - 1))
+        , literal_(true)
+    {
+        parse_(tmpl, N - 1);
+
+        for (std::size_t i = 0; i < N - 1; ++i)
+            if (static_cast<unsigned char>(tmpl[i]) > 0x7F)
+                segmentCount_ = -1;
+    }
+
+    // Runtime templates (not checked, walked on every call)
+
+    FormatString_(QStringView tmpl) noexcept
+        : utf16_(tmpl)
+    {
+    }
+
+    FormatString_(const QString& tmpl) noexcept
+        : utf16_(tmpl)
+    {
+    }
+
+    // A template (not a plain overload), so string literals still prefer the
+    // array constructors above
+    template <typename T>
+        requires std::same_as<T, const char*> || std::same_as<T, char*>
+    FormatString_(T tmpl) noexcept
+        : utf8_(tmpl)
+        , utf8Size_(tmpl ? qsizetype(std::strlen(tmpl)) : 0)
+    {
+    }
+
+    bool isUtf8() const noexcept { return utf8_ != nullptr; }
+
+    // From a string literal (so it lives as long as the program). Runtime
+    // templates may be gone as soon as the call returns
+    bool isLiteral() const noexcept { return literal_; }
+    const char* utf8() const noexcept { return utf8_; }
+    QStringView utf16() const noexcept { return utf16_; }
+
+    // Pre-parsed at compile time (so format won't walk it)
+    bool isParsed() const noexcept { return segmentCount_ >= 0; }
+
+    // The template as-is (no substitution, no unescaping)
+    QString toString() const
+    {
+        return utf8_ ? QString::fromUtf8(utf8_, utf8Size_)
+                     : utf16_.toString();
+    }
+
+    // Appends the template as-is (for zero args)
+    template <typename OutT> void appendVerbatim(OutT& out) const
+    {
+        if (!utf8_) {
+            out.append(utf16_);
+        } else if (isParsed()) {
+            out.append(QLatin1StringView(utf8_, utf8Size_));
+        } else {
+            auto decoded = QString::fromUtf8(utf8_, utf8Size_);
+            out.append(QStringView(decoded));
+        }
+    }
+
+    // Size to reserve before formatTo. Exact for parsed templates whose args
+    // are all text
+    qsizetype sizeHint(const ArgView_* values, qsizetype count) const
+    {
+        auto total = isParsed() ? literalSize_
+                     : utf8_    ? utf8Size_
+                                : utf16_.size();
+
+        for (qsizetype i = 0; i < count; ++i)
+            total += values[i].size();
+
+        return total;
+    }
+
+    template <typename OutT>
+    void formatTo(OutT& out, const ArgView_* values, qsizetype count) const
+    {
+        if (!isParsed()) {
+            if (!utf8_) {
+                formatTo_(out, utf16_, values, count);
+                return;
+            }
+
+            auto decoded = QString::fromUtf8(utf8_, utf8Size_);
+            formatTo_(out, decoded, values, count);
+            return;
+        }
+
+        qsizetype next_arg = 0;
+
+        for (auto i = 0; i < segmentCount_; ++i) {
+            auto& segment = segments_[i];
+
+            if (segment.begin == ARG_SLOT_) {
+                values[next_arg++].appendTo(out, segment.spec);
+            } else if (utf8_) {
+                out.append(
+                    QLatin1StringView(utf8_ + segment.begin, segment.size));
+            } else {
+                out.append(utf16_.sliced(segment.begin, segment.size));
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t CAPACITY_ =
+        sizeof...(Args) * 2 + 1 + ESCAPE_SLACK_;
+
+    QStringView utf16_{};
+    const char* utf8_ = nullptr;
+    qsizetype utf8Size_ = 0;
+    bool literal_ = false;
+    std::array<Segment_, CAPACITY_> segments_{};
+    int segmentCount_ = -1;
+    qsizetype literalSize_ = 0;
+
+    // Same rules as format_ (and counts the slots as it goes)
+    template <typename CharT>
+    consteval void parse_(const CharT* data, std::size_t size)
+    {
+        std::size_t count = 0;
+        std::size_t placeholders = 0;
+        auto fits = size < ARG_SLOT_;
+
+        auto push = [&](std::size_t begin,
+                        std::size_t length,
+                        const Spec_& spec = {}) {
+            if (length < 1 && begin != ARG_SLOT_)
+                return;
+            if (count == CAPACITY_) {
+                fits = false;
+                return;
+            }
 
-                out.append(u'}');
+            segments_[count].begin = quint16(begin);
+            segments_[count].size = quint16(length);
+            segments_[count].spec = spec;
+            ++count;
+
+            if (begin != ARG_SLOT_)
+                literalSize_ += qsizetype(length);
+        };
+
+        std::size_t run_start = 0;
+        std::size_t i = 0;
+
+        while (i < size) {
+            auto ch = data[i];
+            auto next = i + 1 < size ? data[i + 1] : CharT{};
+
+            // Escapes end the run after their first brace
+            if ((ch == '{' && next == '{') || (ch == '}' && next == '}')) {
+                push(run_start, i + 1 - run_start);
                 i += 2;
                 run_start = i;
-
                 continue;
             }
+
+            if (ch == '{' && (next == '}' || next == ':')) {
+                Spec_ spec{};
+                auto end = next == '}' ? qsizetype(i + 1)
+                                       : parseSpec_(
+                                             data,
+                                             qsizetype(size),
+                                             qsizetype(i + 2),
+                                             spec);
+
+                if (end > 0) {
+                    push(run_start, i - run_start);
+                    push(ARG_SLOT_, 0, spec);
+                    ++placeholders;
+                    i = std::size_t(end + 1);
+                    run_start = i;
+                    continue;
+                }
+            }
+
+            ++i;
         }
 
-        ++i;
-    }
+        push(run_start, size - run_start);
+
+        // Zero-arg templates are never substituted (see Fmt::format)
+        if (sizeof...(Args) > 0 && placeholders != sizeof...(Args))
+            placeholderCountDoesNotMatchArgumentCount_();
 
-    // Flush trailing literal
-    if (run_start < size) {
-        out.append(QStringView(data + run_start, size - run_start));
+        segmentCount_ = fits ? int(count) : -1;
     }
+};
 
-    return out;
+} // namespace Internal
+
+// A format template for Args. String literals are parsed at compile time into
+// literal runs and argument slots, so formatting just copies them in order. A
+// literal whose field count ({} or {:spec}, see Internal::Spec_) doesn't match
+// the argument count won't compile. Runtime templates (QString, QStringView,
+// const char*) still work and are walked on every call, where extra fields are
+// dropped and extra args ignored.
+// Character arrays count as literals, so pass a runtime buffer as a pointer
+template <typename... Args>
+using FormatString = Internal::FormatString_<std::type_identity_t<Args>...>;
+
+// No args means no substitution: the template is returned as-is (including any
+// {{ or }}), so arbitrary text can be passed through safely
+template <typename... Args>
+inline QString format(FormatString<Args...> tmpl, Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 0) {
+        return tmpl.toString();
+    } else {
+        auto values = Internal::expand_(std::forward<Args>(args)...);
+
+        QString out{};
+        out.reserve(tmpl.sizeHint(values.data(), values.size()));
+        tmpl.formatTo(out, values.data(), values.size());
+
+        return out;
+    }
 }
 
-} // namespace Internal
+// Same, but appends to out (a QString or SmallString) instead of returning a
+// new string, so a buffer the caller holds on to can be reused. Reserving only
+// grows out, never shrinks it
+template <Internal::Output_ OutT, typename... Args>
+inline void formatTo(OutT& out, FormatString<Args...> tmpl, Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 0) {
+        tmpl.appendVerbatim(out);
+    } else {
+        auto values = Internal::expand_(std::forward<Args>(args)...);
+        out.reserve(out.size() + tmpl.sizeHint(values.data(), values.size()));
+        tmpl.formatTo(out, values.data(), values.size());
+    }
+}
 
-// Zero-arg fast path (no allocation, no walk)
-inline QString format(QStringView tmpl) { return tmpl.toString(); }
+// The exact length format would return (lazy args are evaluated for it)
+template <typename... Args>
+inline qsizetype formattedSize(FormatString<Args...> tmpl, Args&&... args)
+{
+    Internal::Counter_ counter{};
+    formatTo(counter, tmpl, std::forward<Args>(args)...);
+    return counter.size();
+}
 
+// Two passes over the same args: one to measure, one to write, so the result
+// is allocated once at exactly its size. Worth it for strings that are kept
+// (queued or stored) rather than used and dropped
 template <typename... Args>
-inline QString format(QStringView tmpl, Args&&... args)
+inline QString formatExact(FormatString<Args...> tmpl, Args&&... args)
 {
-    auto values = Internal::expand_(std::forward<Args>(args)...);
-    return Internal::format_(tmpl, values.data(), values.size());
+    if constexpr (sizeof...(Args) == 0) {
+        return tmpl.toString();
+    } else {
+        auto values = Internal::expand_(std::forward<Args>(args)...);
+
+        Internal::Counter_ counter{};
+        tmpl.formatTo(counter, values.data(), values.size());
+
+        QString out{};
+        out.reserve(counter.size());
+        tmpl.formatTo(out, values.data(), values.size());
+
+        return out;
+    }
 }
 
 } // namespace Coco::Fmt
@@ -0,0 +1,119 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QObject>
+#include <QStringView>
+#include <QtLogging>
+
+#include "Coco/Path.h"
+
+namespace Coco::Debug {
+
+class Category;
+
+namespace Internal {
+
+struct CategoryAccess_;
+extern Category defaultCategory_;
+
+} // namespace Internal
+
+// A named log level, like QLoggingCategory but for Coco's macros. Levels are
+// kept in severity() terms (see Debug.h). Categories live for the life of the
+// process, so a call site can hold on to one and check it with a single relaxed
+// load (see COCO_LOG_CATEGORY and CDEBUG, etc.)
+class Category
+{
+public:
+    constexpr Category(const char* name, int floor) noexcept
+        : name_(name)
+        , floor_(floor)
+        , gate_(floor)
+    {
+    }
+
+    Category(const Category&) = delete;
+    Category& operator=(const Category&) = delete;
+
+    const char* name() const noexcept { return name_; }
+
+    // Lines below this severity are dropped
+    int floor() const noexcept
+    {
+        return floor_.load(std::memory_order::relaxed);
+    }
+
+    // Lowest severity that could get through, counting any per-object override
+    // that is more verbose than the floor. Only the macros' pre-check uses this
+    int gate() const noexcept
+    {
+        return gate_.load(std::memory_order::relaxed);
+    }
+
+private:
+    friend struct Internal::CategoryAccess_;
+
+    const char* name_;
+    std::atomic<int> floor_;
+    std::atomic<int> gate_;
+};
+
+// What the plain DEBUG/INFO/WARN/CRITICAL macros log to
+inline Category& defaultCategory() noexcept
+{
+    return Internal::defaultCategory_;
+}
+
+// Finds or registers a category. The name is copied
+Category& category(const char* name);
+
+// Qt-style filter rules, one per line or separated by ';', e.g.:
+//   "net.*=debug; net.http=warning; *=info"
+// Patterns may start and/or end with '*'. Levels are debug, info, warning,
+// critical and off (off still lets FATAL through). Later rules win, and
+// categories no rule matches follow init's verbosity. Replaces any previous
+// rules. Debug::init reads them from COCO_LOG_RULES, or from the file named by
+// COCO_LOG_RULES_FILE
+void setLogRules(QStringView rules);
+
+// Same, from a file (where lines starting with '#' are comments). Call it
+// again to pick up changes. Returns false if the file can't be read
+bool loadLogRules(const Path& file);
+
+// Per-object level, ahead of any category or rule, for LOG calls made with obj
+// as their QObject context. Cleared when obj is destroyed
+void setObjectLevel(QObject* obj, QtMsgType level);
+void clearObjectLevel(const QObject* obj);
+
+namespace Internal {
+
+// Set while any per-object level exists, so Log only looks them up then
+extern std::atomic<bool> hasObjectLevels_;
+
+bool objectAllows_(const QObject* obj, int severity, const Category& category);
+
+// Debug::init's verbosity, for categories no rule matches
+void setBaseFloor_(int floor);
+
+} // namespace Internal
+
+} // namespace Coco::Debug
+
+// Defines a file-local handle to a category, looked up once at static init:
+//   COCO_LOG_CATEGORY(netLog, "net");
+//   CDEBUG(netLog, "Connected to {}", host);
+#define COCO_LOG_CATEGORY(Name, CategoryName)                                  \
+    static Coco::Debug::Category& Name = Coco::Debug::category(CategoryName)
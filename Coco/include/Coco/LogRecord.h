@@ -0,0 +1,236 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <concepts>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include <QByteArray>
+#include <QLatin1StringView>
+#include <QMetaObject>
+#include <QObject>
+#include <QString>
+#include <QStringView>
+#include <QtLogging>
+#include <QtTypes>
+
+#include "Coco/Concepts.h"
+#include "Coco/Fmt.h"
+#include "Coco/ToQString.h"
+
+namespace Coco::Debug {
+
+// A log call captured for deferred formatting (see Debug::setStructured).
+// Holds the call site, a timestamp, the format, and the raw argument values in
+// a compact tagged byte buffer. Short messages fit in the inline buffer, so
+// capturing one doesn't allocate. Numbers, bools, strings and QObject pointers
+// are stored as-is; anything else goes through toQString at capture time (the
+// same as Fmt's fallback). render() produces the text Fmt::format would have
+class Record
+{
+public:
+    enum class Tag : quint8
+    {
+        Int,
+        UInt,
+        Float,
+        Double,
+        Bool,
+        Utf16,
+        Utf8,
+        Latin1,
+        Object
+    };
+
+    Record() = default;
+
+    Record(
+        QtMsgType type,
+        const char* file,
+        int line,
+        const char* function,
+        const QObject* obj)
+        : type(type)
+        , file(file)
+        , line(line)
+        , function(function)
+    {
+        if (obj) {
+            className = obj->metaObject()->className();
+            object = obj;
+        }
+    }
+
+    QtMsgType type = QtDebugMsg;
+    const char* file = nullptr;
+    int line = 0;
+    const char* function = nullptr;
+
+    // Category name (static, or owned by the category registry)
+    const char* category = nullptr;
+
+    // The QObject context, if any. The class name comes from static meta-object
+    // data, so it stays valid even if the object is destroyed before render
+    const char* className = nullptr;
+    const void* object = nullptr;
+
+    // In whatever clock Debug is set to (see Debug::timestampNow)
+    qint64 nsecs = 0;
+    quint64 count = 0;
+
+    // Captured by pointer, so the format has to outlive the record (only
+    // pass literals; copy anything else in as a QStringView)
+    void setFormat(const char* utf8) noexcept
+    {
+        formatUtf8_ = utf8;
+        formatInPayload_ = false;
+    }
+
+    // Copied into the payload (must be called before append)
+    void setFormat(QStringView format)
+    {
+        formatUtf8_ = nullptr;
+        formatInPayload_ = true;
+        putUtf16_(format);
+    }
+
+    template <typename T> void append(T&& value)
+    {
+        using U = std::remove_cvref_t<T>;
+        using D = std::decay_t<T>;
+
+        if constexpr (Fmt::Internal::IsLazy_<U>::value) {
+            append(value.fn());
+            return;
+        } else if constexpr (std::same_as<U, bool>) {
+            put_(Tag::Bool);
+            putScalar_(static_cast<quint8>(value));
+        } else if constexpr (std::integral<U> && !std::same_as<U, char>) {
+            if constexpr (std::is_signed_v<U>) {
+                put_(Tag::Int);
+                putScalar_(static_cast<qint64>(value));
+            } else {
+                put_(Tag::UInt);
+                putScalar_(static_cast<quint64>(value));
+            }
+        } else if constexpr (std::same_as<U, float>) {
+            put_(Tag::Float);
+            putScalar_(value);
+        } else if constexpr (std::floating_point<U>) {
+            put_(Tag::Double);
+            putScalar_(static_cast<double>(value));
+        } else if constexpr (
+            std::same_as<U, QString> || std::same_as<U, QStringView> ||
+            std::same_as<D, const char16_t*> || std::same_as<D, char16_t*>) {
+            putUtf16_(QStringView(value));
+        } else if constexpr (std::same_as<U, QLatin1StringView>) {
+            put_(Tag::Latin1);
+            putBytes_(value.data(), value.size());
+        } else if constexpr (
+            std::same_as<D, const char*> || std::same_as<D, char*>) {
+            put_(Tag::Utf8);
+            putBytes_(value, value ? qsizetype(std::strlen(value)) : 0);
+        } else if constexpr (
+            std::is_pointer_v<U> &&
+            Concepts::QObjectDerived<
+                std::remove_cv_t<std::remove_pointer_t<U>>>) {
+            put_(Tag::Object);
+            putScalar_(
+                value ? value->metaObject()->className()
+                      : static_cast<const char*>(nullptr));
+            putScalar_(static_cast<const void*>(value));
+        } else {
+            putUtf16_(toQString(std::forward<T>(value)));
+        }
+
+        ++argCount_;
+    }
+
+    int argCount() const noexcept { return argCount_; }
+
+    // Formats the message (without the count/timestamp prefix the log file
+    // adds). Meant for the writer thread, or anything else that decodes later
+    QString render() const;
+
+private:
+    static constexpr qsizetype INLINE_SIZE_ = 128;
+
+    const char* formatUtf8_ = nullptr;
+    bool formatInPayload_ = false;
+    bool spilled_ = false;
+    int argCount_ = 0;
+    qsizetype size_ = 0;
+    alignas(8) char inline_[INLINE_SIZE_];
+    QByteArray spill_{};
+
+    const char* data_() const noexcept
+    {
+        return spilled_ ? spill_.constData() : inline_;
+    }
+
+    char* reserve_(qsizetype n)
+    {
+        if (!spilled_ && size_ + n <= INLINE_SIZE_)
+            return inline_ + size_;
+
+        if (!spilled_) {
+            spill_.reserve((size_ + n) * 2);
+            spill_.append(inline_, size_);
+            spilled_ = true;
+        }
+
+        spill_.resize(size_ + n);
+        return spill_.data() + size_;
+    }
+
+    void put_(Tag tag) { putScalar_(static_cast<quint8>(tag)); }
+
+    template <typename T> void putScalar_(T value)
+    {
+        std::memcpy(reserve_(sizeof(T)), &value, sizeof(T));
+        size_ += sizeof(T);
+    }
+
+    void putBytes_(const void* bytes, qsizetype size)
+    {
+        putScalar_(size);
+        if (size < 1)
+            return;
+
+        std::memcpy(reserve_(size), bytes, size);
+        size_ += size;
+    }
+
+    // Padded so the decoder can view the code units in place
+    void putUtf16_(QStringView text)
+    {
+        put_(Tag::Utf16);
+        putScalar_(text.size());
+
+        if (auto pad = size_ % qsizetype(alignof(char16_t))) {
+            reserve_(pad);
+            size_ += pad;
+        }
+
+        if (text.isEmpty())
+            return;
+
+        auto bytes = text.size() * qsizetype(sizeof(char16_t));
+        std::memcpy(reserve_(bytes), text.utf16(), bytes);
+        size_ += bytes;
+    }
+};
+
+} // namespace Coco::Debug
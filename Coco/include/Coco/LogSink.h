@@ -0,0 +1,82 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QtLogging>
+#include <QtTypes>
+
+namespace Coco::Debug {
+
+using LogSink = std::function<void(const QString&)>;
+using BatchLogSink = std::function<void(const QStringList&)>;
+using SinkId = quint64;
+
+// Where (and how often) a sink is called
+enum class SinkDelivery
+{
+    // On the logging thread, line by line. A slow sink slows every caller
+    Inline,
+
+    // On a thread of the sink's own, with whatever piled up since the last call
+    Queued,
+
+    // On the context object's thread, one event per batch (e.g., a console
+    // widget gets everything logged since its last event loop tick at once)
+    Posted
+};
+
+struct SinkOptions
+{
+    // Lines below this level never reach the sink
+    QtMsgType level = QtDebugMsg;
+    SinkDelivery delivery = SinkDelivery::Inline;
+
+    // Posted only (without one, Posted acts like Inline). The sink is removed
+    // when the context is destroyed
+    QObject* context = nullptr;
+
+    // Lines a Queued or Posted sink can have waiting before new ones are
+    // dropped (and counted in droppedCount). 0 for no limit
+    int capacity = 8192;
+};
+
+// Each sink gets every line written to the log file (at or above its level),
+// prefix and all. Safe to call from any thread. A sink that logs is called
+// again for its own lines, so don't
+SinkId addLogSink(LogSink sink, const SinkOptions& options = {});
+
+// Same, but called with a list of lines. Inline sinks get one line per call
+SinkId addBatchLogSink(BatchLogSink sink, const SinkOptions& options = {});
+
+// A Queued sink is called for what it already has pending, then its thread
+// stops. Posted batches already in the event queue are dropped
+void removeLogSink(SinkId id);
+
+namespace Internal {
+
+extern std::atomic<bool> hasSinks_;
+
+// Debug's hooks: one call per log line, flush() and droppedCount()
+void fanOut_(QtMsgType type, const QString& line);
+void flushSinks_();
+quint64 sinkDropped_() noexcept;
+
+} // namespace Internal
+
+} // namespace Coco::Debug
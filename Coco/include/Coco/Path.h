@@ -19,7 +19,9 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <type_traits>
 
+#include <QByteArray>
 #include <QDataStream>
 #include <QDebug>
 #include <QDir>
@@ -27,18 +29,17 @@
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QHashFunctions>
 #include <QList>
-#include <QSharedData>
-#include <QSharedDataPointer>
 #include <QStandardPaths>
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 #include <QTextStream>
 #include <QWidget>
 
 #include "Coco/Bool.h"
-
-#define STD_TO_QSTR_(StdPath) QString::fromStdString(StdPath.string())
+#include "Coco/Simd.h"
 
 namespace Coco {
 
@@ -47,34 +48,41 @@ namespace Coco {
 // functionality as well as various utility functions to make it easier to work
 // with (and to allow avoidance of `QDir`, `QFile`, and related classes unless
 // really needed)
+//
+// A Path is a single implicitly shared QString (the path as given). It's taken
+// apart in place, by the same grammar as `std::filesystem::path`, and the
+// ...View methods return views into it (valid until the Path is modified or
+// destroyed). A `std::filesystem::path` or `std::string` is only made when
+// asked for
 class Path
 {
 public:
-    Path()
-        : d_(new SharedData_)
-    {
-    }
-
+    Path() = default;
     Path(const Path& other) = default;
     Path(Path&& other) noexcept = default;
 
     Path(const std::filesystem::path& path)
-        : d_(new SharedData_(path))
+        : text_(fromStd_(path))
     {
     }
 
     Path(const char* path)
-        : d_(new SharedData_(path))
+        : text_(QString::fromUtf8(path))
     {
     }
 
     Path(const std::string& path)
-        : d_(new SharedData_(path))
+        : text_(QString::fromStdString(path))
     {
     }
 
     Path(const QString& path)
-        : d_(new SharedData_(path.toStdString()))
+        : text_(path)
+    {
+    }
+
+    Path(QStringView path)
+        : text_(path.toString())
     {
     }
 
@@ -82,15 +90,12 @@ public:
 
     friend QDataStream& operator>>(QDataStream& in, Path& path)
     {
-        QString s{};
-        in >> s;
-        path = Path(s);
-        return in;
+        return in >> path.text_;
     }
 
     friend QDataStream& operator<<(QDataStream& out, const Path& path)
     {
-        return out << path.d_->qstr();
+        return out << path.text_;
     }
 
     template <class CharT, class TraitsT>
@@ -107,20 +112,20 @@ public:
     friend std::basic_ostream<CharT, TraitsT>&
     operator<<(std::basic_ostream<CharT, TraitsT>& out, const Path& path)
     {
-        return out << path.d_->path;
+        return out << path.toStd();
     }
 
     // Output only. By returning a QDebug object (not a reference), we allow the
     // chaining of multiple operator<< calls
     friend QDebug operator<<(QDebug debug, const Path& path)
     {
-        return debug << path.d_->qstr();
+        return debug << path.text_;
     }
 
     // Output only (input skipped due to whitespace limitation)
     friend QTextStream& operator<<(QTextStream& out, const Path& path)
     {
-        return out << path.d_->qstr();
+        return out << path.text_;
     }
 
     // ----- Assignment operators -----
@@ -132,14 +137,36 @@ public:
     // operator== and operator<=> are sufficient; the compiler synthesizes !=,
     // <, >, <=, and >= from these two (C++20)
 
+    // Element-wise, like `std::filesystem::path` (so "a//b" == "a/b")
     bool operator==(const Path& other) const noexcept
     {
-        return d_->path == other.d_->path;
+        return text_ == other.text_ || compare_(text_, other.text_) == 0;
     }
 
     std::strong_ordering operator<=>(const Path& other) const noexcept
     {
-        return d_->path <=> other.d_->path;
+        return compare_(text_, other.text_);
+    }
+
+    // Consistent with operator==
+    friend size_t qHash(const Path& path, size_t seed = 0) noexcept
+    {
+        QStringView text(path.text_);
+        auto parts = parse_(text);
+
+        // Root name separators compare equal, so leave them out
+        auto root_name = text.first(parts.rootNameEnd);
+        while (!root_name.isEmpty() && isSep_(root_name[0]))
+            root_name = root_name.sliced(1);
+
+        seed = qHash(root_name, seed);
+        seed = qHash(parts.hasRootDir(), seed);
+
+        Elements_ elements(text.sliced(parts.rootDirEnd));
+        for (QStringView element{}; elements.next(element);)
+            seed = qHash(element, seed);
+
+        return seed;
     }
 
     // ----- Concatenation operators -----
@@ -151,105 +178,187 @@ public:
 
     Path& operator/=(const Path& other)
     {
-        d_->path /= other.d_->path;
-        d_->invalidateCache();
+        // Copied first, since other may be this (the copy shares the buffer)
+        auto rhs = other.text_;
+        auto r = parse_(rhs);
+        auto l = parse_(text_);
+        auto rhs_root_name = QStringView(rhs).first(r.rootNameEnd);
+
+        if (r.isAbsolute() ||
+            (!rhs_root_name.isEmpty() &&
+             compareRootNames_(
+                 rhs_root_name,
+                 QStringView(text_).first(l.rootNameEnd)) != 0)) {
+            text_ = rhs;
+            return *this;
+        }
+
+        if (r.hasRootDir())
+            text_.truncate(l.rootNameEnd);
+        else if (l.hasName())
+            text_ += SEPARATOR_;
+
+        text_ += QStringView(rhs).sliced(r.rootNameEnd);
         return *this;
     }
 
     Path& operator+=(const Path& other)
     {
-        d_->path += other.d_->path;
-        d_->invalidateCache();
+        text_ += other.text_;
         return *this;
     }
 
     // ----- Queries -----
 
-    bool isEmpty() const noexcept { return d_->path.empty(); }
+    bool isEmpty() const noexcept { return text_.isEmpty(); }
 
     bool isFile() const
     {
-        // return std::filesystem::is_regular_file(d_->path);
+        // return std::filesystem::is_regular_file(toStd());
         //  ^ Valid paths with non-standard characters won't return valid
-        return QFileInfo(d_->qstr()).isFile();
+        return QFileInfo(text_).isFile();
     }
 
     bool isDir() const
     {
-        // return std::filesystem::is_directory(d_->path);
+        // return std::filesystem::is_directory(toStd());
         //  ^ Valid paths with non-standard characters won't return valid
-        return QFileInfo(d_->qstr()).isDir();
+        return QFileInfo(text_).isDir();
     }
 
     bool isEmptyDir() const
     {
         if (!isDir())
             return false;
-        return QDir(d_->qstr())
-            .isEmpty(QDir::AllEntries | QDir::NoDotAndDotDot);
+        return QDir(text_).isEmpty(QDir::AllEntries | QDir::NoDotAndDotDot);
     }
 
     bool exists() const
     {
-        // return std::filesystem::exists(d_->path);
+        // return std::filesystem::exists(toStd());
         //  ^ Valid paths with non-standard characters won't return valid
-        return QFileInfo(d_->qstr()).exists();
+        return QFileInfo(text_).exists();
     }
 
     // ----- Decomposition -----
 
-    Path rootName() const { return d_->path.root_name(); }
-    Path rootDir() const { return d_->path.root_directory(); }
-    Path root() const { return d_->path.root_path(); }
-    Path relative() const { return d_->path.relative_path(); }
-    Path parent() const { return d_->path.parent_path(); }
-    Path name() const { return d_->path.filename(); }
-    Path stem() const { return d_->path.stem(); }
-    Path ext() const { return d_->path.extension(); }
+    Path rootName() const { return rootNameView(); }
+    Path rootDir() const { return rootDirView(); }
+    Path root() const { return rootView(); }
+    Path relative() const { return relativeView(); }
+    Path parent() const { return parentView(); }
+    Path name() const { return nameView(); }
+    Path stem() const { return stemView(); }
+    Path ext() const { return extView(); }
 
-    // ----- Modification -----
+    // Views into this Path's text (no allocation)
+
+    QStringView rootNameView() const noexcept
+    {
+        return QStringView(text_).first(parse_(text_).rootNameEnd);
+    }
+
+    QStringView rootDirView() const noexcept
+    {
+        auto parts = parse_(text_);
+        return QStringView(text_).sliced(
+            parts.rootNameEnd,
+            parts.hasRootDir() ? 1 : 0);
+    }
+
+    QStringView rootView() const noexcept
+    {
+        auto parts = parse_(text_);
+        return QStringView(text_).first(
+            parts.rootNameEnd + (parts.hasRootDir() ? 1 : 0));
+    }
+
+    QStringView relativeView() const noexcept
+    {
+        return QStringView(text_).sliced(parse_(text_).rootDirEnd);
+    }
+
+    // The whole path when there's no relative part (the parent of "/" is "/"),
+    // and the root when the name is all there is of it
+    QStringView parentView() const noexcept
+    {
+        auto parts = parse_(text_);
+        if (parts.rootDirEnd == parts.size)
+            return text_;
+
+        auto end = parts.nameStart;
+        while (end > parts.rootDirEnd && isSep_(text_[end - 1]))
+            --end;
+
+        if (end == parts.rootDirEnd)
+            return rootView();
+
+        return QStringView(text_).first(end);
+    }
 
-    // Re: noexcept: Non-const access to d_ (QSharedDataPointer::operator->())
-    // may call detach(), which copies via `new` and can throw std::bad_alloc.
-    // So despite the underlying std::filesystem::path operations and
-    // invalidateCache() all being noexcept, these mutating methods cannot
-    // guarantee noexcept
+    QStringView nameView() const noexcept
+    {
+        return QStringView(text_).sliced(parse_(text_).nameStart);
+    }
+
+    QStringView stemView() const noexcept
+    {
+        auto parts = parse_(text_);
+        auto ext_start = extStart_(text_, parts);
+        return QStringView(text_).sliced(
+            parts.nameStart,
+            ext_start - parts.nameStart);
+    }
 
-    void clear()
+    QStringView extView() const noexcept
     {
-        d_->path.clear();
-        d_->invalidateCache();
+        return QStringView(text_).sliced(extStart_(text_, parse_(text_)));
     }
 
+    // ----- Modification -----
+
+    // Re: noexcept: Mutating a QString that shares its buffer with other
+    // copies detaches it first, which allocates and can throw std::bad_alloc.
+    // So these mutating methods cannot guarantee noexcept
+
+    void clear() { text_.clear(); }
+
     Path& makePreferred()
     {
-        d_->path.make_preferred();
-        d_->invalidateCache();
+        if constexpr (WINDOWS_)
+            text_.replace(u'/', u'\\');
         return *this;
     }
 
     Path& replaceExt(const Path& replacement = {})
     {
-        d_->path.replace_extension(replacement.d_->path);
-        d_->invalidateCache();
+        // Copied first, since replacement may be this
+        auto ext = replacement.text_;
+        text_.truncate(extStart_(text_, parse_(text_)));
+
+        if (!ext.isEmpty()) {
+            if (!ext.startsWith(u'.'))
+                text_ += u'.';
+            text_ += ext;
+        }
+
         return *this;
     }
 
     Path& replaceName(const Path& replacement)
     {
-        d_->path.replace_filename(replacement.d_->path);
-        d_->invalidateCache();
-        return *this;
+        auto name = replacement;
+        removeName();
+        return *this /= name;
     }
 
     Path& removeName()
     {
-        d_->path.remove_filename();
-        d_->invalidateCache();
+        text_.truncate(parse_(text_).nameStart);
         return *this;
     }
 
-    void swap(Path& other) noexcept { d_.swap(other.d_); }
+    void swap(Path& other) noexcept { text_.swap(other.text_); }
 
     friend void swap(Path& a, Path& b) noexcept { a.swap(b); }
 
@@ -257,76 +366,175 @@ public:
 
     Path rebase(const Path& oldBase, const Path& newBase) const
     {
-        auto rel = d_->path.lexically_relative(oldBase.d_->path);
-        if (rel.empty())
+        auto rel = lexicallyRelative(oldBase);
+        if (rel.isEmpty())
             return {};
-        if (rel == std::filesystem::path("."))
+        if (rel.text_ == QStringView(u"."))
             return newBase;
-        return newBase.d_->path / rel;
+        return newBase / rel;
     }
 
+    // As `std::filesystem::path::lexically_relative` (empty when there's no
+    // relative path, such as between different roots)
     Path lexicallyRelative(const Path& base) const
     {
-        return d_->path.lexically_relative(base.d_->path);
-    }
+        QStringView text(text_);
+        QStringView base_text(base.text_);
+        auto parts = parse_(text);
+        auto base_parts = parse_(base_text);
+
+        if (compareRootNames_(
+                text.first(parts.rootNameEnd),
+                base_text.first(base_parts.rootNameEnd)) != 0 ||
+            parts.hasRootDir() != base_parts.hasRootDir())
+            return {};
 
-    std::string genericString() const { return d_->path.generic_string(); }
+        Elements_ elements(text.sliced(parts.rootDirEnd));
+        Elements_ base_elements(base_text.sliced(base_parts.rootDirEnd));
+        QStringView element{};
+        QStringView base_element{};
+        auto more = elements.next(element);
+        auto base_more = base_elements.next(base_element);
 
-    QString extQString() const { return STD_TO_QSTR_(d_->path.extension()); }
-    std::string extString() const { return d_->path.extension().string(); }
-    QString nameQString() const { return STD_TO_QSTR_(d_->path.filename()); }
-    std::string nameString() const { return d_->path.filename().string(); }
+        while (more && base_more && element == base_element) {
+            more = elements.next(element);
+            base_more = base_elements.next(base_element);
+        }
 
-    // For a uniform display path (single forward slashes and no trailing slash,
-    // with no other changes (keeps dot and dot-dot))
-    QString prettyQString() const
+        if (!more && !base_more)
+            return Path(".");
+
+        // Levels to climb out of what's left of base
+        auto levels = 0;
+
+        for (; base_more; base_more = base_elements.next(base_element)) {
+            if (base_element == QStringView(u".."))
+                --levels;
+            else if (
+                !base_element.isEmpty() && base_element != QStringView(u"."))
+                ++levels;
+        }
+
+        if (levels < 0)
+            return {};
+        if (levels == 0 && (!more || element.isEmpty()))
+            return Path(".");
+
+        Path result{};
+        auto append = [&](QStringView name) {
+            if (!result.text_.isEmpty())
+                result.text_ += SEPARATOR_;
+            result.text_ += name;
+        };
+
+        for (; levels > 0; --levels)
+            append(u"..");
+        for (; more; more = elements.next(element))
+            append(element);
+
+        return result;
+    }
+
+    // Forward slashes, with repeats collapsed (except in a root name, where
+    // "//host" keeps both)
+    std::string genericString() const
     {
-        return QString::fromStdString(prettyString());
+        QStringView text(text_);
+        auto root_name_end = parse_(text).rootNameEnd;
+        auto generic = text.first(root_name_end).toString();
+        generic.reserve(text.size());
+
+        if constexpr (WINDOWS_)
+            generic.replace(u'\\', u'/');
+
+        for (auto i = root_name_end; i < text.size();) {
+            auto sep = findSep_(text, i);
+            generic.append(text.sliced(i, sep - i));
+
+            if (sep == text.size())
+                break;
+
+            generic += u'/';
+            i = sep + 1;
+
+            while (i < text.size() && isSep_(text[i]))
+                ++i;
+        }
+
+        return generic.toStdString();
     }
 
+    QString extQString() const { return extView().toString(); }
+    std::string extString() const { return extView().toUtf8().toStdString(); }
+    QString nameQString() const { return nameView().toString(); }
+    std::string nameString() const { return nameView().toUtf8().toStdString(); }
+
     // For a uniform display path (single forward slashes and no trailing slash,
     // with no other changes (keeps dot and dot-dot))
     // Edge case: a bare "//" input will be reduced to "/". This is acceptable
     // since bare UNC prefixes are not valid paths
     // TODO (maybe): Caching? If this was used to display a path in a tree view,
     // for example, we might need it?
-    std::string prettyString() const
+    QString prettyQString() const
     {
-        auto& d_str = d_->str();
-        std::string pretty{};
-        pretty.reserve(d_str.size());
+        QStringView text(text_);
+        auto data = text.utf16();
+        auto size = text.size();
+        QString pretty{};
+        pretty.reserve(size);
         auto last_was_sep = false;
 
-        for (auto& ch : d_str) {
-            if (ch == '/' || ch == '\\') {
-                if (!last_was_sep) {
-                    pretty += '/';
-                    last_was_sep = true;
-                }
-            } else {
-                pretty += ch;
+        // Copy each run between separators whole, then collapse the
+        // separator(s) that end it
+        for (qsizetype i = 0; i < size;) {
+            auto sep = Simd::findEither(data, size, i, u'/', u'\\');
+
+            if (sep > i) {
+                pretty.append(text.sliced(i, sep - i));
                 last_was_sep = false;
             }
+
+            if (sep == size)
+                break;
+
+            if (!last_was_sep) {
+                pretty += u'/';
+                last_was_sep = true;
+            }
+
+            i = sep + 1;
         }
 
         // Don't strip if the slash is the root directory component
-        if (pretty.size() > 1 && pretty.back() == '/' &&
-            pretty[pretty.size() - 2] != ':') {
-            pretty.pop_back();
+        if (pretty.size() > 1 && pretty.endsWith(u'/') &&
+            pretty.at(pretty.size() - 2) != u':') {
+            pretty.chop(1);
         }
 
         return pretty;
     }
 
-    QString stemQString() const { return STD_TO_QSTR_(d_->path.stem()); }
-    std::string stemString() const { return d_->path.stem().string(); }
+    // For a uniform display path (single forward slashes and no trailing slash,
+    // with no other changes (keeps dot and dot-dot))
+    std::string prettyString() const { return prettyQString().toStdString(); }
+
+    QString stemQString() const { return stemView().toString(); }
+    std::string stemString() const { return stemView().toUtf8().toStdString(); }
 
-    std::filesystem::path toStd() const { return d_->path; }
-    QString toQString() const { return d_->qstr(); }
-    std::string toString() const { return d_->str(); }
+    std::filesystem::path toStd() const
+    {
+        if constexpr (NATIVE_WIDE_)
+            return text_.toStdWString();
+        else
+            return text_.toStdString();
+    }
+
+    // Implicitly shared (no copy)
+    QString toQString() const { return text_; }
+    std::string toString() const { return text_.toStdString(); }
 
     // For batch queries
-    QFileInfo toQFileInfo() const { return QFileInfo(d_->qstr()); }
+    QFileInfo toQFileInfo() const { return QFileInfo(text_); }
 
     // ----- Utility -----
 
@@ -366,56 +574,197 @@ public:
 #undef GEN_STD_DIR_METHOD_2_
 
 private:
-    // Thread safety: SharedData_ relies on QSharedData's copy-on-write for
-    // mutation safety, but const methods (str(), qstr()) lazily populate
-    // mutable cache fields. If two threads share the same underlying data (no
-    // prior write to trigger COW detachment) and both call a const method
-    // concurrently, they will race on the cache. This is fine for typical
-    // GUI-thread usage but needs care in multithreaded console applications
-    class SharedData_ : public QSharedData
+    // The grammar follows the platform's `std::filesystem`: on Windows, '\' is
+    // a separator too, and a path may start with a root name ("C:", "//host")
+    static constexpr auto WINDOWS_ =
+        std::filesystem::path::preferred_separator == '\\';
+    static constexpr auto SEPARATOR_ = WINDOWS_ ? u'\\' : u'/';
+    static constexpr auto NATIVE_WIDE_ =
+        std::is_same_v<std::filesystem::path::value_type, wchar_t>;
+
+    // Thread safety: the text is a QString, whose implicit sharing is
+    // reentrant, so Paths sharing a buffer can be read from any number of
+    // threads at once (and written from one thread each, as any value type)
+    QString text_;
+
+    // Offsets into the text: [root name][root dir separators][relative part],
+    // where the relative part ends with the name (empty after a trailing
+    // separator)
+    struct Parts_
     {
-    public:
-        explicit SharedData_(const std::filesystem::path& other = {})
-            : path(other)
-        {
-        }
+        qsizetype rootNameEnd = 0;
+        qsizetype rootDirEnd = 0;
+        qsizetype nameStart = 0;
+        qsizetype size = 0;
 
-        std::filesystem::path path;
+        bool hasRootDir() const noexcept { return rootDirEnd > rootNameEnd; }
+        bool hasName() const noexcept { return nameStart < size; }
 
-        void invalidateCache() noexcept
+        bool isAbsolute() const noexcept
         {
-            stringValid_ = false;
-            qStringValid_ = false;
+            return hasRootDir() && (!WINDOWS_ || rootNameEnd > 0);
         }
+    };
 
-        const QString& qstr() const
+    // Walks a relative part element by element, as `std::filesystem::path`
+    // iterates it ("a//b/" is "a", "b", then an empty name)
+    class Elements_
+    {
+    public:
+        explicit Elements_(QStringView text) noexcept
+            : text_(text)
         {
-            if (!qStringValid_) {
-                cachedQString_ = QString::fromStdString(str());
-                qStringValid_ = true;
-            }
-
-            return cachedQString_;
         }
 
-        const std::string& str() const
+        bool next(QStringView& element) noexcept
         {
-            if (!stringValid_) {
-                cachedString_ = path.string();
-                stringValid_ = true;
+            auto size = text_.size();
+
+            if (pos_ == size) {
+                if (!trailing_)
+                    return false;
+
+                trailing_ = false;
+                element = {};
+                return true;
             }
 
-            return cachedString_;
+            auto end = findSep_(text_, pos_);
+            element = text_.sliced(pos_, end - pos_);
+            pos_ = end;
+
+            while (pos_ < size && isSep_(text_[pos_]))
+                ++pos_;
+
+            trailing_ = end < size;
+            return true;
         }
 
     private:
-        mutable bool qStringValid_ = false;
-        mutable bool stringValid_ = false;
-        mutable QString cachedQString_{};
-        mutable std::string cachedString_{};
+        QStringView text_;
+        qsizetype pos_ = 0;
+        bool trailing_ = false;
     };
 
-    QSharedDataPointer<SharedData_> d_;
+    static constexpr bool isSep_(QChar c) noexcept
+    {
+        return c.unicode() == u'/' || (WINDOWS_ && c.unicode() == u'\\');
+    }
+
+    static qsizetype findSep_(QStringView text, qsizetype from) noexcept
+    {
+        return Simd::findEither(
+            text.utf16(),
+            text.size(),
+            from,
+            u'/',
+            WINDOWS_ ? u'\\' : u'/');
+    }
+
+    static Parts_ parse_(QStringView text) noexcept
+    {
+        Parts_ parts{};
+        parts.size = text.size();
+        qsizetype i = 0;
+
+        if constexpr (WINDOWS_) {
+            auto letter = text.size() >= 2 ? text[0].unicode() | 0x20 : 0;
+            auto drive = text.size() >= 2 && text[1].unicode() == u':' &&
+                         letter >= u'a' && letter <= u'z';
+
+            // A UNC host ("//host") is two separators and a name
+            if (drive)
+                i = 2;
+            else if (
+                text.size() >= 3 && isSep_(text[0]) && isSep_(text[1]) &&
+                !isSep_(text[2]))
+                i = findSep_(text, 2);
+        }
+
+        parts.rootNameEnd = i;
+
+        while (i < parts.size && isSep_(text[i]))
+            ++i;
+
+        parts.rootDirEnd = i;
+        parts.nameStart = parts.size;
+
+        if (i < parts.size) {
+            auto j = parts.size;
+            while (j > i && !isSep_(text[j - 1]))
+                --j;
+            parts.nameStart = j;
+        }
+
+        return parts;
+    }
+
+    // Where the extension starts in the name (the last dot, unless it's the
+    // first character, as in ".profile"), or the end of the text
+    static qsizetype extStart_(QStringView text, const Parts_& parts) noexcept
+    {
+        auto name = text.sliced(parts.nameStart);
+        if (name == QStringView(u".") || name == QStringView(u".."))
+            return parts.size;
+
+        auto dot = name.lastIndexOf(u'.');
+        return dot > 0 ? parts.nameStart + dot : parts.size;
+    }
+
+    // Separators in a root name ("//host") are interchangeable
+    static std::strong_ordering
+    compareRootNames_(QStringView a, QStringView b) noexcept
+    {
+        auto unit = [](QChar c) { return isSep_(c) ? u'/' : c.unicode(); };
+        auto size = qMin(a.size(), b.size());
+
+        for (qsizetype i = 0; i < size; ++i)
+            if (auto order = unit(a[i]) <=> unit(b[i]); order != 0)
+                return order;
+
+        return a.size() <=> b.size();
+    }
+
+    // Root name, then root directory (without before with), then each element
+    // by code unit
+    static std::strong_ordering compare_(QStringView a, QStringView b) noexcept
+    {
+        auto a_parts = parse_(a);
+        auto b_parts = parse_(b);
+
+        if (auto order = compareRootNames_(
+                a.first(a_parts.rootNameEnd),
+                b.first(b_parts.rootNameEnd));
+            order != 0)
+            return order;
+
+        if (auto order = a_parts.hasRootDir() <=> b_parts.hasRootDir();
+            order != 0)
+            return order;
+
+        Elements_ a_elements(a.sliced(a_parts.rootDirEnd));
+        Elements_ b_elements(b.sliced(b_parts.rootDirEnd));
+        QStringView a_element{};
+        QStringView b_element{};
+
+        while (true) {
+            auto a_more = a_elements.next(a_element);
+            auto b_more = b_elements.next(b_element);
+
+            if (!a_more || !b_more)
+                return a_more <=> b_more;
+            if (auto order = a_element.compare(b_element) <=> 0; order != 0)
+                return order;
+        }
+    }
+
+    static QString fromStd_(const std::filesystem::path& path)
+    {
+        if constexpr (NATIVE_WIDE_)
+            return QString::fromStdWString(path.wstring());
+        else
+            return QString::fromStdString(path.string());
+    }
 };
 
 using PathList = QList<Path>;
@@ -527,41 +876,23 @@ inline QStringList toPrettyQStringList(const PathList& paths)
     return result;
 }
 
-// Iterator wrappers
+// Iterator wrappers (lazily, see Coco::walk in Walk.h; for big trees, see
+// Coco::scan in Scan.h). The two below are defined in Walk.cpp, on top of walk,
+// and so never list "." or ".."
 
 // Provide extensions as: `{ "*.mp3", "*.wav" }`
-inline PathList paths(
+PathList paths(
     const Path& dir,
     const QStringList& exts,
     QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot,
-    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags)
-{
-    PathList result{};
-    QDirIterator it(dir.toQString(), exts, filters, flags);
-
-    while (it.hasNext()) {
-        it.next();
-        result << it.filePath();
-    }
-
-    return result;
-}
+    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
 
 // Provide extensions as: `{ "*.mp3", "*.wav" }`
-inline PathList paths(
+PathList paths(
     const PathList& dirs,
     const QStringList& exts,
     QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot,
-    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags)
-{
-    PathList result{};
-
-    for (auto& dir : dirs) {
-        result << paths(dir, exts, filters, flags);
-    }
-
-    return result;
-}
+    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
 
 inline PathList paths(
     const Path& dir,
@@ -723,10 +1054,7 @@ namespace std {
 
 template <> struct hash<Coco::Path>
 {
-    size_t operator()(const Coco::Path& path) const
-    {
-        return hash<filesystem::path>()(path.toStd());
-    }
+    size_t operator()(const Coco::Path& path) const { return qHash(path); }
 };
 
 template <> struct formatter<Coco::Path> : formatter<string>
@@ -739,8 +1067,6 @@ template <> struct formatter<Coco::Path> : formatter<string>
 
 } // namespace std
 
-#undef STD_TO_QSTR_
-
 Q_DECLARE_METATYPE(Coco::Path)
 
 /// TODO Add to Smoke.cpp?:
@@ -0,0 +1,79 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QList>
+#include <QStringList>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+// Parallel counterpart to paths() for big trees. A pool of workers each lists
+// one directory at a time (getdents64 on Linux, a flat QDirIterator elsewhere),
+// filters in place, and queues subdirectories on its own deque. A worker that
+// runs dry steals the oldest queued directory from another (the one nearest
+// the root, so the biggest share of what's left)
+//
+// Entries are filtered as QDirIterator filters them (same exts globs, same
+// QDir::Filters), except that "." and ".." are never listed. Results come in
+// no particular order:
+//
+// auto music = Coco::scan(
+//     Coco::Path::Music(),
+//     { .exts = { "*.mp3", "*.wav" }, .filters = QDir::Files });
+namespace Coco {
+
+struct ScanOptions
+{
+    // Provide extensions as: `{ "*.mp3", "*.wav" }`
+    QStringList exts{};
+    QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot;
+    QDirIterator::IteratorFlags flags = QDirIterator::Subdirectories;
+
+    // Worker count, including the calling thread (0 for one per core)
+    int threads = 0;
+
+    // For scanEntries: also capture each entry's size, mtime and permissions
+    // (one stat per entry found)
+    bool stat = false;
+
+    // As WalkOptions::prune, but called from the workers (so it must be
+    // thread-safe). Runs before the directory is queued, so before it's listed
+    std::function<bool(const Path&)> prune{};
+};
+
+// What each worker found, one chunk per worker (none are merged or copied)
+QList<PathList>
+scanChunks(const PathList& dirs, const ScanOptions& options = {});
+
+PathList scan(const PathList& dirs, const ScanOptions& options = {});
+
+inline PathList scan(const Path& dir, const ScanOptions& options = {})
+{
+    return scan(PathList{ dir }, options);
+}
+
+// As scan, with what the listing learned about each entry (see DirEntry)
+DirEntryList scanEntries(const PathList& dirs, const ScanOptions& options = {});
+
+inline DirEntryList
+scanEntries(const Path& dir, const ScanOptions& options = {})
+{
+    return scanEntries(PathList{ dir }, options);
+}
+
+} // namespace Coco
@@ -0,0 +1,155 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <type_traits>
+
+#include <QtTypes>
+
+// Picked at compile time from what the compiler may emit: SSE2 is baseline on
+// x86-64 (and on x86 with /arch:SSE2 or -msse2). AVX2 needs /arch:AVX2 or
+// -mavx2 (or -march that implies it). Anything else takes the scalar loop
+#if defined(__AVX2__)
+#    define COCO_SIMD_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) ||               \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define COCO_SIMD_SSE2
+#endif
+
+#if defined(COCO_SIMD_AVX2)
+#    include <immintrin.h>
+#elif defined(COCO_SIMD_SSE2)
+#    include <emmintrin.h>
+#endif
+
+// Vectorized searches for the text scanners (Fmt's walker, Path's separator
+// pass), so long literal runs are skipped a register at a time and copied in
+// bulk rather than looked at one character at a time
+namespace Coco::Simd {
+
+namespace Internal {
+
+template <typename CharT>
+concept Unit_ = std::same_as<CharT, char> || std::same_as<CharT, char16_t>;
+
+template <Unit_ CharT>
+inline qsizetype scalarFindEither_(
+    const CharT* data,
+    qsizetype size,
+    qsizetype from,
+    CharT a,
+    CharT b) noexcept
+{
+    for (auto i = from; i < size; ++i)
+        if (data[i] == a || data[i] == b)
+            return i;
+
+    return size;
+}
+
+} // namespace Internal
+
+// Index of the first unit in [from, size) equal to a or b, or size if there
+// isn't one
+template <Internal::Unit_ CharT>
+inline qsizetype findEither(
+    const CharT* data,
+    qsizetype size,
+    qsizetype from,
+    CharT a,
+    CharT b) noexcept
+{
+    auto i = from;
+
+    // Each match sets sizeof(CharT) bits of the byte mask
+    [[maybe_unused]] constexpr auto UNIT = int(sizeof(CharT));
+
+#if defined(COCO_SIMD_AVX2)
+
+    constexpr auto WIDTH = qsizetype(32 / UNIT);
+    __m256i va{};
+    __m256i vb{};
+
+    if constexpr (UNIT == 1) {
+        va = _mm256_set1_epi8(static_cast<char>(a));
+        vb = _mm256_set1_epi8(static_cast<char>(b));
+    } else {
+        va = _mm256_set1_epi16(static_cast<short>(a));
+        vb = _mm256_set1_epi16(static_cast<short>(b));
+    }
+
+    for (; i + WIDTH <= size; i += WIDTH) {
+        auto chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hits{};
+
+        if constexpr (UNIT == 1)
+            hits = _mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, va),
+                _mm256_cmpeq_epi8(chunk, vb));
+        else
+            hits = _mm256_or_si256(
+                _mm256_cmpeq_epi16(chunk, va),
+                _mm256_cmpeq_epi16(chunk, vb));
+
+        auto mask = static_cast<quint32>(_mm256_movemask_epi8(hits));
+        if (mask)
+            return i + std::countr_zero(mask) / UNIT;
+    }
+
+#endif
+
+#if defined(COCO_SIMD_SSE2)
+
+    constexpr auto WIDTH_SSE = qsizetype(16 / UNIT);
+    __m128i sa{};
+    __m128i sb{};
+
+    if constexpr (UNIT == 1) {
+        sa = _mm_set1_epi8(static_cast<char>(a));
+        sb = _mm_set1_epi8(static_cast<char>(b));
+    } else {
+        sa = _mm_set1_epi16(static_cast<short>(a));
+        sb = _mm_set1_epi16(static_cast<short>(b));
+    }
+
+    for (; i + WIDTH_SSE <= size; i += WIDTH_SSE) {
+        auto chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hits{};
+
+        if constexpr (UNIT == 1)
+            hits = _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, sa),
+                _mm_cmpeq_epi8(chunk, sb));
+        else
+            hits = _mm_or_si128(
+                _mm_cmpeq_epi16(chunk, sa),
+                _mm_cmpeq_epi16(chunk, sb));
+
+        auto mask = static_cast<quint32>(_mm_movemask_epi8(hits));
+        if (mask)
+            return i + std::countr_zero(mask) / UNIT;
+    }
+
+#endif
+
+    // Tail (or everything, without SIMD)
+    return Internal::scalarFindEither_(data, size, i, a, b);
+}
+
+} // namespace Coco::Simd
@@ -0,0 +1,155 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMetaObject>
+#include <QtTypes>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+// Opt-in memo for Path's disk queries (isFile, isDir, isEmptyDir, exists and
+// the rest), for callers that ask about the same paths over and over, like a
+// tree model repainting. One stat per path fills in everything QFileInfo would
+// say about it; the answer stands until the ttl runs out, the path is
+// invalidated, or invalidateAll moves the cache to a new generation
+//
+// Thread-safe (disk reads happen outside the lock), and bounded: past capacity,
+// the least recently asked-about path is dropped
+//
+// Coco::StatCache cache({ .ttl = std::chrono::seconds(5) });
+// cache.setWatcher(&watcher); // Precise invalidation for watched paths
+//
+// if (cache.isDir(path)) ...
+namespace Coco {
+
+struct StatCacheOptions
+{
+    // Paths kept, at most
+    qsizetype capacity = 4096;
+
+    // How long an answer stands (0 for until invalidated)
+    std::chrono::milliseconds ttl{ 1000 };
+};
+
+struct StatCacheStats
+{
+    qint64 hits = 0;
+    qint64 misses = 0;
+    qsizetype size = 0;
+};
+
+class StatCache
+{
+public:
+    explicit StatCache(const StatCacheOptions& options = {});
+    ~StatCache();
+
+    StatCache(const StatCache&) = delete;
+    StatCache& operator=(const StatCache&) = delete;
+
+    // Type, size, mtime and permissions, as QFileInfo reports them
+    DirEntry entry(const Path& path);
+
+    bool exists(const Path& path) { return entry(path).exists(); }
+    bool isFile(const Path& path) { return entry(path).isFile(); }
+    bool isDir(const Path& path) { return entry(path).isDir(); }
+    bool isSymLink(const Path& path) { return entry(path).isSymLink(); }
+    qint64 size(const Path& path) { return entry(path).size(); }
+
+    QDateTime lastModified(const Path& path)
+    {
+        return entry(path).lastModified();
+    }
+
+    // Listed once per cached answer, like the rest
+    bool isEmptyDir(const Path& path);
+
+    // Forgets path, and the emptiness of its parent (whatever happened to
+    // path may have changed that)
+    void invalidate(const Path& path);
+
+    // Forgets dir and every cached path directly inside it
+    void invalidateDir(const Path& dir);
+
+    // Every answer so far goes stale at once (no walk of the cache; stale
+    // entries are refreshed or pushed out as they're reached)
+    void invalidateAll() noexcept { ++generation_; }
+
+    void clear();
+
+    // Invalidates on the watcher's signals: a changed file by itself, and a
+    // changed directory with its cached contents. Which paths are watched is
+    // left to the caller (and the watcher to its own thread). Pass nullptr to
+    // stop listening; once it (or the destructor) returns, no slot is still
+    // using the cache
+    void setWatcher(QFileSystemWatcher* watcher);
+
+    StatCacheStats stats() const;
+    void resetStats() noexcept;
+
+private:
+    using Clock_ = std::chrono::steady_clock;
+
+    struct Record_
+    {
+        DirEntry entry;
+        Clock_::time_point expires;
+        std::uint64_t generation;
+        int emptyDir = -1; // Unknown until asked
+    };
+
+    // Most recently used first; the index points into it
+    using Lru_ = std::list<Record_>;
+
+    // Shared with the watcher's slots, which may outlive the cache
+    struct WatchGuard_
+    {
+        std::mutex mutex{};
+        StatCache* cache = nullptr;
+    };
+
+    StatCacheOptions options_;
+    mutable std::mutex mutex_{};
+    Lru_ lru_{};
+    QHash<Path, Lru_::iterator> index_{};
+    std::atomic<std::uint64_t> generation_{ 0 };
+
+    // Bumped by every per-path invalidation (under mutex_), so a stat that
+    // raced one isn't cached
+    std::uint64_t invalidations_ = 0;
+    std::atomic<qint64> hits_{ 0 };
+    std::atomic<qint64> misses_{ 0 };
+    QMetaObject::Connection fileChanged_{};
+    QMetaObject::Connection directoryChanged_{};
+    std::shared_ptr<WatchGuard_> watchGuard_{};
+
+    static DirEntry stat_(const Path& path);
+
+    // Under mutex_: the live record for path, moved to the front, or null
+    Record_* find_(const Path& path);
+    void insert_(Record_ record);
+    void erase_(const Path& path);
+};
+
+} // namespace Coco
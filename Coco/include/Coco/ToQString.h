@@ -12,27 +12,46 @@
 
 #pragma once
 
+#include <charconv>
+#include <cmath>
 #include <concepts>
+#include <initializer_list>
 #include <type_traits>
+#include <utility>
 
 #ifdef COCO_HAS_XML
 #    include <QDomAttr>
 #    include <QDomElement>
 #    include <QDomNamedNodeMap>
 #endif
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
 #include <QHashIterator>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
 #include <QLatin1StringView>
+#include <QLine>
+#include <QLineF>
 #include <QMapIterator>
 #include <QMetaObject>
 #include <QMetaType>
 #include <QModelIndex>
 #include <QObject>
 #include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
 #include <QString>
 #include <QStringList>
 #include <QStringView>
 #include <QVariant>
 #include <QVariantHash>
+#include <QVariantList>
 #include <QVariantMap>
 
 #include "Coco/Bool.h"
@@ -43,121 +62,420 @@ namespace Coco {
 
 using namespace Qt::StringLiterals;
 
+// appendQString(out, value) writes value's text onto the end of out, and is
+// the real implementation: toQString(value) is appendQString into a fresh
+// QString. Containers append their values into the same buffer, so a nested
+// QVariantMap renders into one growing string instead of a temporary per value
+
 // Forward declarations for mutually-recursive overloads. QVariant can hold any
-// of these, and the container overloads call back into toQString for values
-QString toQString(const QVariant& variant);
-QString toQString(const QVariantHash& variantHash);
-QString toQString(const QVariantMap& variantMap);
+// of these, and the container overloads call back into appendQString for
+// values
+void appendQString(QString& out, const QVariant& variant);
+void appendQString(QString& out, const QVariantHash& variantHash);
+void appendQString(QString& out, const QVariantMap& variantMap);
+void appendQString(QString& out, const QVariantList& variantList);
+void appendQString(QString& out, const QJsonValue& value);
+void appendQString(QString& out, const QCborValue& value);
 
 // --- Strings ---
 
-// Passthrough (implicitly shared, no copy)
-inline QString toQString(const QString& s) { return s; }
-inline QString toQString(QStringView s) { return s.toString(); }
-inline QString toQString(QLatin1StringView s) { return s.toString(); }
-inline QString toQString(const char* s) { return QString::fromUtf8(s); }
+inline void appendQString(QString& out, const QString& s) { out.append(s); }
+inline void appendQString(QString& out, QStringView s) { out.append(s); }
+
+inline void appendQString(QString& out, QLatin1StringView s)
+{
+    out.append(s);
+}
+
+inline void appendQString(QString& out, const char* s)
+{
+    out.append(QString::fromUtf8(s));
+}
 
 // --- Bool ---
 
-inline QString toQString(bool b) { return b ? u"true"_s : u"false"_s; }
+inline void appendQString(QString& out, bool b)
+{
+    out.append(b ? u"true"_s : u"false"_s);
+}
 
 // --- Numerics ---
 
+// Integers don't need QString::number's temporary (to_chars gives the same
+// digits)
 template <typename T>
     requires std::integral<T> && (!std::same_as<T, bool>) &&
              (!std::same_as<T, char>)
-inline QString toQString(T value)
+inline void appendQString(QString& out, T value)
 {
-    return QString::number(value);
+    char buffer[24];
+    auto last = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    out.append(QLatin1StringView(buffer, last));
 }
 
-template <std::floating_point T> inline QString toQString(T value)
+// Same text as QString::number (%g, 6 significant digits), without the
+// temporary
+template <std::floating_point T>
+inline void appendQString(QString& out, T value)
 {
-    return QString::number(value);
+    char buffer[32];
+    auto last = std::to_chars(
+                    buffer,
+                    buffer + sizeof(buffer),
+                    static_cast<double>(value),
+                    std::chars_format::general,
+                    6)
+                    .ptr;
+    out.append(QLatin1StringView(buffer, last));
 }
 
+// --- Render limits ---
+
+// Caps on what one render writes, so a huge structure can be logged without
+// stalling on (or allocating) all of it. Elided elements end the container
+// with "... (+N more)". Zero means no limit. The defaults come from
+// Debug::setRenderLimits, and toQString(value, limits) overrides them for one
+// call
+struct RenderLimits
+{
+    // Elements per container (QStringList, QVariantMap, QVariantHash)
+    qsizetype maxElements = 0;
+
+    // Containers nested deeper render as "QVariantMap(...)" (or "..." for a
+    // QStringList)
+    int maxDepth = 0;
+
+    // UTF-16 code units, checked before each element (so a single element can
+    // still run past it)
+    qsizetype maxSize = 0;
+};
+
+namespace Internal {
+
+RenderLimits defaultRenderLimits_() noexcept;
+void setDefaultRenderLimits_(const RenderLimits& limits) noexcept;
+
+// Per thread, for the render in progress. A render is everything written into
+// one output string from its outermost container down
+struct RenderState_
+{
+    const QString* out = nullptr;
+    const RenderLimits* override = nullptr;
+    RenderLimits limits{};
+    qsizetype start = 0;
+    int depth = 0;
+};
+
+inline thread_local RenderState_ renderState_{};
+
+// Per-call limits, for every render started while it's alive
+class RenderLimitsScope_
+{
+public:
+    explicit RenderLimitsScope_(const RenderLimits& limits) noexcept
+        : previous_(std::exchange(renderState_.override, &limits))
+    {
+    }
+
+    ~RenderLimitsScope_() { renderState_.override = previous_; }
+
+    RenderLimitsScope_(const RenderLimitsScope_&) = delete;
+    RenderLimitsScope_& operator=(const RenderLimitsScope_&) = delete;
+
+private:
+    const RenderLimits* previous_;
+};
+
+// One container level. The outermost (or the first into a different output
+// string, like a renderer building a temporary) picks up the limits and
+// where the render started
+class RenderLevel_
+{
+public:
+    explicit RenderLevel_(const QString& out)
+    {
+        auto& state = renderState_;
+
+        if (state.out != &out) {
+            saved_ = state;
+            restore_ = true;
+
+            state.out = &out;
+            state.limits = state.override ? *state.override
+                                          : defaultRenderLimits_();
+            state.start = out.size();
+            state.depth = 0;
+        }
+
+        depth_ = ++state.depth;
+    }
+
+    ~RenderLevel_()
+    {
+        auto& state = renderState_;
+        --state.depth;
+
+        if (restore_)
+            state = saved_;
+    }
+
+    RenderLevel_(const RenderLevel_&) = delete;
+    RenderLevel_& operator=(const RenderLevel_&) = delete;
+
+    bool tooDeep() const noexcept
+    {
+        auto max = renderState_.limits.maxDepth;
+        return max > 0 && depth_ > max;
+    }
+
+    // A reserve for count elements of about perElement each, capped by what
+    // the limits will let through
+    qsizetype sizeHint(qsizetype count, qsizetype perElement) const noexcept
+    {
+        auto& limits = renderState_.limits;
+
+        if (limits.maxElements > 0)
+            count = qMin(count, limits.maxElements);
+
+        auto size = 64 + count * perElement;
+
+        if (limits.maxSize > 0)
+            size = qMin(size, 64 + limits.maxSize);
+
+        return size;
+    }
+
+    // Whether to stop before element index of count, having written the
+    // marker if so
+    bool elide(QString& out, qsizetype index, qsizetype count) const
+    {
+        auto& state = renderState_;
+        auto& limits = state.limits;
+
+        if (!(limits.maxElements > 0 && index >= limits.maxElements) &&
+            !(limits.maxSize > 0 && out.size() - state.start >= limits.maxSize))
+            return false;
+
+        out.append(u"... (+"_s);
+        appendQString(out, count - index);
+        out.append(u" more)"_s);
+
+        return true;
+    }
+
+private:
+    RenderState_ saved_{};
+    bool restore_ = false;
+    int depth_ = 0;
+};
+
+} // namespace Internal
+
 // --- Pointers ---
 
 // Ptr can be nullptr
-template <typename T> inline QString toQString(const T* ptr)
+template <typename T> inline void appendQString(QString& out, const T* ptr)
 {
-    if (!ptr)
-        return u"nullptr"_s;
+    if (!ptr) {
+        out.append(u"nullptr"_s);
+        return;
+    }
 
     // TODO: Untested - check print output (implementation defined)
-    return QString::asprintf(
+    out.append(QString::asprintf(
         "%s(%p)",
         typeid(T).name(),
-        static_cast<const void*>(ptr));
+        static_cast<const void*>(ptr)));
 }
 
 // Ptr can be nullptr. Overrides the generic pointer overload via partial
 // ordering when T derives from QObject
-template <Concepts::QObjectDerived T> inline QString toQString(const T* ptr)
+template <Concepts::QObjectDerived T>
+inline void appendQString(QString& out, const T* ptr)
 {
-    if (!ptr)
-        return u"nullptr"_s;
+    if (!ptr) {
+        out.append(u"nullptr"_s);
+        return;
+    }
 
-    return QString::asprintf(
+    out.append(QString::asprintf(
         "%s(%p)",
         ptr->metaObject()->className(),
-        static_cast<const void*>(ptr));
+        static_cast<const void*>(ptr)));
 }
 
 // --- Qt value types ---
 
-inline QString toQString(const QModelIndex& index)
+inline void appendQString(QString& out, const QModelIndex& index)
+{
+    if (!index.isValid()) {
+        out.append(u"QModelIndex(Invalid)"_s);
+        return;
+    }
+
+    out.append(u"QModelIndex(row:"_s);
+    appendQString(out, index.row());
+    out.append(u", col:"_s);
+    appendQString(out, index.column());
+    out.append(QString::asprintf(", %p)", index.internalPointer()));
+}
+
+namespace Internal {
+
+// Writes "Name(label:value, ...)". Used by the geometry types, so they all read
+// like QPoint
+template <typename... Ts>
+inline void appendFields_(
+    QString& out,
+    QStringView name,
+    std::initializer_list<QStringView> labels,
+    const Ts&... values)
 {
-    if (!index.isValid())
-        return u"QModelIndex(Invalid)"_s;
+    auto label = labels.begin();
+    auto first = true;
+
+    out.append(name);
+    out.append(u'(');
+
+    (
+        [&] {
+            if (!first)
+                out.append(u", "_s);
+            first = false;
+
+            out.append(*label++);
+            out.append(u':');
+            appendQString(out, values);
+        }(),
+        ...);
+
+    out.append(u')');
+}
+
+} // namespace Internal
 
-    return QString::asprintf(
-        "QModelIndex(row:%d, col:%d, %p)",
-        index.row(),
-        index.column(),
-        index.internalPointer());
+inline void appendQString(QString& out, const QPoint& point)
+{
+    Internal::appendFields_(
+        out,
+        u"QPoint",
+        { u"x", u"y" },
+        point.x(),
+        point.y());
 }
 
-inline QString toQString(const QPoint& point)
+inline void appendQString(QString& out, const QPointF& point)
 {
-    return QString::asprintf("QPoint(x:%d, y:%d)", point.x(), point.y());
+    Internal::appendFields_(
+        out,
+        u"QPointF",
+        { u"x", u"y" },
+        point.x(),
+        point.y());
 }
 
-inline QString toQString(const QStringList& list) { return list.join(u", "_s); }
+inline void appendQString(QString& out, const QSize& size)
+{
+    Internal::appendFields_(
+        out,
+        u"QSize",
+        { u"w", u"h" },
+        size.width(),
+        size.height());
+}
 
-#ifdef COCO_HAS_XML
+inline void appendQString(QString& out, const QSizeF& size)
+{
+    Internal::appendFields_(
+        out,
+        u"QSizeF",
+        { u"w", u"h" },
+        size.width(),
+        size.height());
+}
 
-inline QString toQString(const QDomElement& element)
+inline void appendQString(QString& out, const QRect& rect)
 {
-    if (element.isNull())
-        return u"QDomElement(Null)"_s;
+    Internal::appendFields_(
+        out,
+        u"QRect",
+        { u"x", u"y", u"w", u"h" },
+        rect.x(),
+        rect.y(),
+        rect.width(),
+        rect.height());
+}
 
-    auto tag = element.tagName();
-    auto attrs = element.attributes();
-    auto count = attrs.count();
+inline void appendQString(QString& out, const QRectF& rect)
+{
+    Internal::appendFields_(
+        out,
+        u"QRectF",
+        { u"x", u"y", u"w", u"h" },
+        rect.x(),
+        rect.y(),
+        rect.width(),
+        rect.height());
+}
+
+inline void appendQString(QString& out, const QLine& line)
+{
+    Internal::appendFields_(
+        out,
+        u"QLine",
+        { u"x1", u"y1", u"x2", u"y2" },
+        line.x1(),
+        line.y1(),
+        line.x2(),
+        line.y2());
+}
 
-    if (count == 0) {
-        QString out{};
-        out.reserve(tag.size() + 16); // "QDomElement(<>)" + tag
-        out.append(u"QDomElement(<"_s);
-        out.append(tag);
-        out.append(u">)"_s);
+inline void appendQString(QString& out, const QLineF& line)
+{
+    Internal::appendFields_(
+        out,
+        u"QLineF",
+        { u"x1", u"y1", u"x2", u"y2" },
+        line.x1(),
+        line.y1(),
+        line.x2(),
+        line.y2());
+}
+
+inline void appendQString(QString& out, const QStringList& list)
+{
+    Internal::RenderLevel_ level(out);
 
-        return out;
+    if (level.tooDeep()) {
+        out.append(u"..."_s);
+        return;
     }
 
-    // Rough size estimate: tag + per-attr overhead + names/values
-    qsizetype estimate = tag.size() + 16;
+    for (qsizetype i = 0; i < list.size(); ++i) {
+        if (i > 0)
+            out.append(u", "_s);
 
-    for (auto i = 0; i < count; ++i) {
-        auto attr = attrs.item(i).toAttr();
-        estimate += attr.name().size() + attr.value().size() + 5; // " ='"
+        if (level.elide(out, i, list.size()))
+            break;
+
+        out.append(list[i]);
     }
+}
+
+#ifdef COCO_HAS_XML
+
+inline void appendQString(QString& out, const QDomElement& element)
+{
+    if (element.isNull()) {
+        out.append(u"QDomElement(Null)"_s);
+        return;
+    }
+
+    auto attrs = element.attributes();
+    auto count = attrs.count();
 
-    QString out{};
-    out.reserve(estimate);
     out.append(u"QDomElement(<"_s);
-    out.append(tag);
+    out.append(element.tagName());
 
     for (auto i = 0; i < count; ++i) {
         auto attr = attrs.item(i).toAttr();
@@ -169,353 +487,538 @@ inline QString toQString(const QDomElement& element)
     }
 
     out.append(u">)"_s);
-    return out;
 }
 
 #endif
 
 // --- Variant containers ---
 
-// Like QVariant::toString, we don't wrap printable values in "QVariant(...)"
-inline QString toQString(const QVariant& variant)
+// Writes the value held by variant (of the type it was registered for; see
+// registerQStringRenderer)
+using QStringRenderer = void (*)(QString& out, const QVariant& variant);
+
+// Renders variants holding type with renderer, instead of QVariant::toString
+// (and its converter lookups). Replaces any earlier renderer for the type, and
+// nullptr removes it. Lookups are one index into a flat table per type id, so
+// this pays off for types that are rendered often (big models of variants).
+// See also registerQStringRenderer<T>, below
+void registerQStringRenderer(QMetaType type, QStringRenderer renderer);
+
+namespace Internal {
+
+// Registered renderer for the type id, or nullptr (lock-free)
+QStringRenderer qStringRenderer_(int typeId) noexcept;
+
+} // namespace Internal
+
+// Like QVariant::toString, we don't wrap printable values in "QVariant(...)".
+// Registered types (ToQString.cpp registers every type with an overload here,
+// and QDomElement with XML) come first
+inline void appendQString(QString& out, const QVariant& variant)
 {
-    if (!variant.isValid())
-        return u"QVariant(Invalid)"_s;
-    if (variant.isNull())
-        return u"QVariant(Null)"_s;
+    if (!variant.isValid()) {
+        out.append(u"QVariant(Invalid)"_s);
+        return;
+    }
+
+    if (variant.isNull()) {
+        out.append(u"QVariant(Null)"_s);
+        return;
+    }
+
+    if (auto renderer = Internal::qStringRenderer_(variant.typeId())) {
+        renderer(out, variant);
+        return;
+    }
 
     // Check for QObject-derived pointer types via meta-type flags (the
     // documented-correct way). canConvert<QObject*>() + value<QObject*>() is
     // unreliable for subclasses
     if (variant.metaType().flags() & QMetaType::PointerToQObject) {
-        return toQString(variant.value<QObject*>());
+        appendQString(out, variant.value<QObject*>());
+        return;
     }
 
-#ifdef COCO_HAS_XML
-    if (variant.canConvert<QDomElement>()) {
-        return toQString(variant.value<QDomElement>());
-    }
-#endif
-
-    switch (variant.typeId()) {
-    case QMetaType::QVariantMap:
-        return toQString(variant.value<QVariantMap>());
-
-    case QMetaType::QVariantHash:
-        return toQString(variant.value<QVariantHash>());
+    auto text = variant.toString();
 
-    case QMetaType::QModelIndex:
-        return toQString(variant.value<QModelIndex>());
+    if (text.isEmpty())
+        out.append(u"QVariant(Non-printable)"_s);
+    else
+        out.append(text);
+}
 
-    case QMetaType::QPoint:
-        return toQString(variant.value<QPoint>());
+namespace Internal {
 
-    case QMetaType::QStringList:
-        return toQString(variant.value<QStringList>());
+// Shared by QVariantHash and QVariantMap. Only the outermost container
+// reserves (a guess), since exact-size reserves from nested ones would defeat
+// QString's geometric growth
+template <typename IteratorT, typename ContainerT>
+inline void appendVariantContainer_(
+    QString& out,
+    const ContainerT& container,
+    QStringView name)
+{
+    RenderLevel_ level(out);
+    out.append(name);
 
-    default:
-        auto text = variant.toString();
-        return text.isEmpty() ? u"QVariant(Non-printable)"_s : text;
+    if (level.tooDeep()) {
+        out.append(u"(...)"_s);
+        return;
     }
-}
 
-inline QString toQString(const QVariantHash& variantHash)
-{
-    if (variantHash.isEmpty())
-        return u"QVariantHash()"_s;
+    if (out.size() == name.size())
+        out.reserve(level.sizeHint(container.size(), 32));
 
-    QString out{};
-    out.reserve(64 + variantHash.size() * 32); // rough guess
-    out.append(u"QVariantHash("_s);
+    out.append(u'(');
 
-    auto first = true;
-    QHashIterator<QString, QVariant> it(variantHash);
+    qsizetype index = 0;
+    IteratorT it(container);
 
     while (it.hasNext()) {
         it.next();
-        if (!first)
+        if (index > 0)
             out.append(u", "_s);
-        first = false;
+
+        if (level.elide(out, index++, container.size()))
+            break;
 
         out.append(u"{ \""_s);
         out.append(it.key());
         out.append(u"\", "_s);
-        out.append(toQString(it.value()));
+        appendQString(out, it.value());
         out.append(u" }"_s);
     }
 
     out.append(u')');
-    return out;
 }
 
-inline QString toQString(const QVariantMap& variantMap)
+} // namespace Internal
+
+inline void appendQString(QString& out, const QVariantHash& variantHash)
 {
-    if (variantMap.isEmpty())
-        return u"QVariantMap()"_s;
+    Internal::appendVariantContainer_<QHashIterator<QString, QVariant>>(
+        out,
+        variantHash,
+        u"QVariantHash"_s);
+}
 
-    QString out{};
-    out.reserve(64 + variantMap.size() * 32); // rough guess
-    out.append(u"QVariantMap("_s);
+inline void appendQString(QString& out, const QVariantMap& variantMap)
+{
+    Internal::appendVariantContainer_<QMapIterator<QString, QVariant>>(
+        out,
+        variantMap,
+        u"QVariantMap"_s);
+}
 
-    auto first = true;
-    QMapIterator<QString, QVariant> it(variantMap);
+inline void appendQString(QString& out, const QVariantList& variantList)
+{
+    Internal::RenderLevel_ level(out);
+    out.append(u"QVariantList"_s);
 
-    while (it.hasNext()) {
-        it.next();
-        if (!first)
+    if (level.tooDeep()) {
+        out.append(u"(...)"_s);
+        return;
+    }
+
+    out.append(u'(');
+
+    for (qsizetype i = 0; i < variantList.size(); ++i) {
+        if (i > 0)
             out.append(u", "_s);
-        first = false;
 
-        out.append(u"{ \""_s);
-        out.append(it.key());
-        out.append(u"\", "_s);
-        out.append(toQString(it.value()));
-        out.append(u" }"_s);
+        if (level.elide(out, i, variantList.size()))
+            break;
+
+        appendQString(out, variantList[i]);
     }
 
     out.append(u')');
-    return out;
+}
+
+// --- JSON and CBOR ---
+
+// Written straight into the output (no toJson or toDiagnosticNotation
+// document to copy from). JSON comes out compact, as QJsonDocument::Compact
+// would have it. CBOR is in RFC 8949 diagnostic notation. Both honor
+// RenderLimits, which makes elided output invalid JSON, but only when asked for
+
+namespace Internal {
+
+// Quoted, with JSON escapes
+inline void appendJsonString_(QString& out, QStringView text)
+{
+    static constexpr char16_t HEX[] = u"0123456789abcdef";
+    out.append(u'"');
+
+    qsizetype run_start = 0;
+    auto flush = [&](qsizetype end) {
+        if (end > run_start)
+            out.append(text.sliced(run_start, end - run_start));
+    };
+
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        auto ch = text[i].unicode();
+        char16_t escape = 0;
+
+        switch (ch) {
+        case u'"':
+            escape = u'"';
+            break;
+        case u'\\':
+            escape = u'\\';
+            break;
+        case u'\b':
+            escape = u'b';
+            break;
+        case u'\f':
+            escape = u'f';
+            break;
+        case u'\n':
+            escape = u'n';
+            break;
+        case u'\r':
+            escape = u'r';
+            break;
+        case u'\t':
+            escape = u't';
+            break;
+        default:
+            if (ch >= 0x20)
+                continue;
+            break;
+        }
+
+        flush(i);
+        run_start = i + 1;
+        out.append(u'\\');
+
+        if (escape) {
+            out.append(escape);
+        } else {
+            out.append(u"u00"_s);
+            out.append(HEX[ch >> 4]);
+            out.append(HEX[ch & 0xF]);
+        }
+    }
+
+    flush(text.size());
+    out.append(u'"');
+}
+
+// Shortest text that reads back the same, in %g style
+inline void appendShortest_(QString& out, double value)
+{
+    char buffer[32];
+    auto last = std::to_chars(
+                    buffer,
+                    buffer + sizeof(buffer),
+                    value,
+                    std::chars_format::general)
+                    .ptr;
+    out.append(QLatin1StringView(buffer, last));
+}
+
+// As QJsonDocument writes numbers: whole values (within a double's exact
+// integer range) without a fraction, non-finite ones as null
+inline void appendJsonNumber_(QString& out, double value)
+{
+    constexpr auto EXACT = 9007199254740992.0; // 2^53
+
+    if (!std::isfinite(value))
+        out.append(u"null"_s);
+    else if (value == std::trunc(value) && std::abs(value) <= EXACT)
+        appendQString(out, static_cast<qint64>(value));
+    else
+        appendShortest_(out, value);
+}
+
+} // namespace Internal
+
+inline void appendQString(QString& out, const QJsonArray& array)
+{
+    Internal::RenderLevel_ level(out);
+
+    if (level.tooDeep()) {
+        out.append(u"[...]"_s);
+        return;
+    }
+
+    out.append(u'[');
+
+    for (qsizetype i = 0; i < array.size(); ++i) {
+        if (i > 0)
+            out.append(u',');
+
+        if (level.elide(out, i, array.size()))
+            break;
+
+        appendQString(out, array.at(i));
+    }
+
+    out.append(u']');
+}
+
+inline void appendQString(QString& out, const QJsonObject& object)
+{
+    Internal::RenderLevel_ level(out);
+
+    if (level.tooDeep()) {
+        out.append(u"{...}"_s);
+        return;
+    }
+
+    out.append(u'{');
+    qsizetype index = 0;
+
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        if (index > 0)
+            out.append(u',');
+
+        if (level.elide(out, index++, object.size()))
+            break;
+
+        Internal::appendJsonString_(out, it.key());
+        out.append(u':');
+        appendQString(out, QJsonValue(it.value()));
+    }
+
+    out.append(u'}');
+}
+
+inline void appendQString(QString& out, const QJsonValue& value)
+{
+    switch (value.type()) {
+    case QJsonValue::Null:
+        out.append(u"null"_s);
+        break;
+    case QJsonValue::Bool:
+        appendQString(out, value.toBool());
+        break;
+    case QJsonValue::Double:
+        Internal::appendJsonNumber_(out, value.toDouble());
+        break;
+    case QJsonValue::String:
+        Internal::appendJsonString_(out, value.toString());
+        break;
+    case QJsonValue::Array:
+        appendQString(out, value.toArray());
+        break;
+    case QJsonValue::Object:
+        appendQString(out, value.toObject());
+        break;
+    case QJsonValue::Undefined:
+        out.append(u"undefined"_s);
+        break;
+    }
+}
+
+inline void appendQString(QString& out, const QJsonDocument& document)
+{
+    if (document.isArray())
+        appendQString(out, document.array());
+    else if (document.isObject())
+        appendQString(out, document.object());
+    else
+        out.append(u"QJsonDocument(Null)"_s);
+}
+
+inline void appendQString(QString& out, const QCborArray& array)
+{
+    Internal::RenderLevel_ level(out);
+
+    if (level.tooDeep()) {
+        out.append(u"[...]"_s);
+        return;
+    }
+
+    out.append(u'[');
+
+    for (qsizetype i = 0; i < array.size(); ++i) {
+        if (i > 0)
+            out.append(u", "_s);
+
+        if (level.elide(out, i, array.size()))
+            break;
+
+        appendQString(out, array.at(i));
+    }
+
+    out.append(u']');
+}
+
+inline void appendQString(QString& out, const QCborMap& map)
+{
+    Internal::RenderLevel_ level(out);
+
+    if (level.tooDeep()) {
+        out.append(u"{...}"_s);
+        return;
+    }
+
+    out.append(u'{');
+    qsizetype index = 0;
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        if (index > 0)
+            out.append(u", "_s);
+
+        if (level.elide(out, index++, map.size()))
+            break;
+
+        appendQString(out, QCborValue(it.key()));
+        out.append(u": "_s);
+        appendQString(out, QCborValue(it.value()));
+    }
+
+    out.append(u'}');
+}
+
+inline void appendQString(QString& out, const QCborValue& value)
+{
+    static constexpr char16_t HEX[] = u"0123456789abcdef";
+
+    // DateTime, Url, RegularExpression and Uuid are tags too
+    if (value.isTag()) {
+        appendQString(out, static_cast<quint64>(value.tag()));
+        out.append(u'(');
+        appendQString(out, value.taggedValue());
+        out.append(u')');
+        return;
+    }
+
+    switch (value.type()) {
+    case QCborValue::Integer:
+        appendQString(out, value.toInteger());
+        break;
+
+    case QCborValue::Double: {
+        auto number = value.toDouble();
+
+        if (std::isnan(number)) {
+            out.append(u"NaN"_s);
+        } else if (std::isinf(number)) {
+            out.append(number < 0 ? u"-Infinity"_s : u"Infinity"_s);
+        } else {
+            // Keeps "1.0" apart from the integer 1
+            auto start = out.size();
+            Internal::appendShortest_(out, number);
+
+            if (QStringView(out).sliced(start).indexOf(u'.') < 0 &&
+                QStringView(out).sliced(start).indexOf(u'e') < 0)
+                out.append(u".0"_s);
+        }
+
+        break;
+    }
+
+    case QCborValue::ByteArray: {
+        auto bytes = value.toByteArray();
+        out.append(u"h'"_s);
+
+        for (auto byte : bytes) {
+            auto unit = static_cast<quint8>(byte);
+            out.append(HEX[unit >> 4]);
+            out.append(HEX[unit & 0xF]);
+        }
+
+        out.append(u'\'');
+        break;
+    }
+
+    case QCborValue::String:
+        Internal::appendJsonString_(out, value.toString());
+        break;
+    case QCborValue::Array:
+        appendQString(out, value.toArray());
+        break;
+    case QCborValue::Map:
+        appendQString(out, value.toMap());
+        break;
+    case QCborValue::False:
+        out.append(u"false"_s);
+        break;
+    case QCborValue::True:
+        out.append(u"true"_s);
+        break;
+    case QCborValue::Null:
+        out.append(u"null"_s);
+        break;
+    case QCborValue::Undefined:
+        out.append(u"undefined"_s);
+        break;
+
+    case QCborValue::SimpleType:
+        out.append(u"simple("_s);
+        appendQString(out, static_cast<int>(value.toSimpleType()));
+        out.append(u')');
+        break;
+
+    default:
+        out.append(u"QCborValue(Invalid)"_s);
+        break;
+    }
 }
 
 // --- Coco types ---
 
-inline QString toQString(const Path& path) { return path.toQString(); }
+inline void appendQString(QString& out, const Path& path)
+{
+    out.append(path.toQString());
+}
 
-template <typename TagT> inline QString toQString(const Bool<TagT>& b)
+template <typename TagT>
+inline void appendQString(QString& out, const Bool<TagT>& b)
 {
-    return Bool<TagT>::name(b);
+    out.append(Bool<TagT>::name(b));
 }
 
-} // namespace Coco
+// --- toQString ---
 
-// QVariant Output Test:
+// Anything appendQString can write
+template <typename T>
+concept AppendsToQString = requires(QString& out, const T& value) {
+    appendQString(out, value);
+};
 
-/// TODO Add to Smoke.cpp?
+// Passthrough (implicitly shared, no copy)
+inline QString toQString(const QString& s) { return s; }
 
-/*#include <QByteArray>
-#include <QCborArray>
-#include <QCborMap>
-#include <QCborValue>
-#include <QChar>
-#include <QCoreApplication>
-#include <QDate>
-#include <QDateTime>
-#include <QDebug>
-#include <QDomDocument>
-#include <QDomElement>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
-#include <QLine>
-#include <QLineF>
-#include <QLocale>
-#include <QModelIndex>
-#include <QPoint>
-#include <QPointF>
-#include <QRect>
-#include <QRectF>
-#include <QSize>
-#include <QSizeF>
-#include <QString>
-#include <QStringList>
-#include <QTime>
-#include <QUrl>
-#include <QUuid>
-#include <QVariant>
-#include <QVariantHash>
-#include <QVariantList>
-#include <QVariantMap>
+template <AppendsToQString T> inline QString toQString(const T& value)
+{
+    QString out{};
+    appendQString(out, value);
+    return out;
+}
 
-void testVariantToString(const QString& typeName, const QVariant& variant)
-{
-    QString result = variant.toString();
-    qDebug() << qUtf8Printable(QString("%1:").arg(typeName, -25))
-             << qUtf8Printable(result.isEmpty() ? "<empty>" : result);
-}
-
-int main(int argc, char* argv[])
-{
-    QCoreApplication app(argc, argv);
-
-    qDebug() << "=== String Types ===";
-    testVariantToString("QString", QVariant(QString("Hello")));
-    testVariantToString("QByteArray", QVariant(QByteArray("Byte Array")));
-    testVariantToString("QChar", QVariant(QChar('A')));
-
-    qDebug() << "\n=== Numeric Types ===";
-    testVariantToString("Bool", QVariant(true));
-    testVariantToString("Int", QVariant(55));
-    testVariantToString("UInt", QVariant(55u));
-    testVariantToString("Long", qVar(55L));
-    testVariantToString("ULong", qVar(55UL));
-    testVariantToString("LongLong", QVariant(55LL));
-    testVariantToString("ULongLong", QVariant(55ULL));
-    testVariantToString("Short", qVar(static_cast<short>(55)));
-    testVariantToString(
-        "UShort",
-        qVar(static_cast<unsigned short>(55)));
-    testVariantToString("Char", qVar(static_cast<char>('X')));
-    testVariantToString(
-        "SChar",
-        qVar(static_cast<signed char>('Y')));
-    testVariantToString(
-        "UChar",
-        qVar(static_cast<unsigned char>('Z')));
-    testVariantToString("Float", QVariant(3.14f));
-    testVariantToString("Double", QVariant(3.14159));
-
-    qDebug() << "\n=== Date/Time Types ===";
-    testVariantToString("QDate", QVariant(QDate(2025, 11, 12)));
-    testVariantToString("QTime", QVariant(QTime(14, 30, 45)));
-    testVariantToString("QDateTime", QVariant(QDateTime::currentDateTime()));
-
-    qDebug() << "\n=== Simple Qt Types ===";
-    testVariantToString("QUrl", QVariant(QUrl("https://example.com")));
-    testVariantToString("QUuid", QVariant(QUuid::createUuid()));
-    testVariantToString(
-        "QLocale",
-        QVariant(QLocale(QLocale::English, QLocale::UnitedStates)));
-
-    qDebug() << "\n=== Geometric Types ===";
-    testVariantToString("QPoint", QVariant(QPoint(10, 20)));
-    testVariantToString("QPointF", QVariant(QPointF(10.5, 20.5)));
-    testVariantToString("QSize", QVariant(QSize(100, 200)));
-    testVariantToString("QSizeF", QVariant(QSizeF(100.5, 200.5)));
-    testVariantToString("QRect", QVariant(QRect(10, 20, 100, 200)));
-    testVariantToString("QRectF", QVariant(QRectF(10.5, 20.5, 100.5, 200.5)));
-    testVariantToString("QLine", QVariant(QLine(0, 0, 100, 100)));
-    testVariantToString("QLineF", QVariant(QLineF(0.0, 0.0, 100.5, 100.5)));
-
-    qDebug() << "\n=== Container Types ===";
-    testVariantToString(
-        "QStringList",
-        QVariant(QStringList{ "one", "two", "three" }));
-    testVariantToString(
-        "QVariantList",
-        QVariant(QVariantList{ 1, "two", 3.0 }));
-    testVariantToString(
-        "QVariantMap",
-        QVariant(QVariantMap{ { "key1", 1 }, { "key2", "value" } }));
-    testVariantToString(
-        "QVariantHash",
-        QVariant(QVariantHash{ { "key1", 1 }, { "key2", "value" } }));
-
-    qDebug() << "\n=== Model Types ===";
-    testVariantToString("QModelIndex", qVar(QModelIndex()));
-
-    qDebug() << "\n=== JSON Types ===";
-    testVariantToString(
-        "QJsonValue",
-        qVar(QJsonValue("json string")));
-    testVariantToString(
-        "QJsonObject",
-        qVar(QJsonObject{ { "key", "value" } }));
-    testVariantToString(
-        "QJsonArray",
-        qVar(QJsonArray{ "one", "two", "three" }));
-
-    QJsonDocument jsonDoc(QJsonObject{ { "key", "value" } });
-    testVariantToString("QJsonDocument", qVar(jsonDoc));
-
-    qDebug() << "\n=== CBOR Types ===";
-    testVariantToString(
-        "QCborValue",
-        qVar(QCborValue("cbor string")));
-    testVariantToString(
-        "QCborArray",
-        qVar(QCborArray{ "one", "two" }));
-    testVariantToString(
-        "QCborMap",
-        qVar(QCborMap{ { 1, "value" } }));
-    testVariantToString(
-        "QCborSimpleType",
-        qVar(QCborSimpleType::True));
-
-    qDebug() << "\n=== XML Types ===";
-    QDomDocument doc;
-    QDomElement element = doc.createElement("test");
-    element.setAttribute("attr", "value");
-    testVariantToString("QDomElement", qVar(element));
-
-    qDebug() << "\n=== Special Types ===";
-    testVariantToString("Nullptr", qVar(nullptr));
-    testVariantToString("Invalid", QVariant());
-    testVariantToString("Null QString", QVariant(QString()));
-    testVariantToString("QObjectStar", qVar(new QObject));
-
-    return 0;
-}*/
-
-// Output:
-
-/*=== String Types ===
-QString                  : Hello
-QByteArray               : Byte Array
-QChar                    : A
-
-=== Numeric Types ===
-Bool                     : true
-Int                      : 55
-UInt                     : 55
-Long                     : 55
-ULong                    : 55
-LongLong                 : 55
-ULongLong                : 55
-Short                    : 55
-UShort                   : 55
-Char                     : X
-SChar                    : Y
-UChar                    : Z
-Float                    : 3.140000104904175
-Double                   : 3.14159
-
-=== Date/Time Types ===
-QDate                    : 2025-11-12
-QTime                    : 14:30:45.000
-QDateTime                : 2025-11-12T22:06:24.208
-
-=== Simple Qt Types ===
-QUrl                     : https://example.com
-QUuid                    : {d180b01f-c6f1-4a48-a0d6-c8a1b6ac6ae8}
-QLocale                  : <empty>
-
-=== Geometric Types ===
-QPoint                   : <empty>
-QPointF                  : <empty>
-QSize                    : <empty>
-QSizeF                   : <empty>
-QRect                    : <empty>
-QRectF                   : <empty>
-QLine                    : <empty>
-QLineF                   : <empty>
-
-=== Container Types ===
-QStringList              : <empty>
-QVariantList             : <empty>
-QVariantMap              : <empty>
-QVariantHash             : <empty>
-
-=== Model Types ===
-QModelIndex              : <empty>
-
-=== JSON Types ===
-QJsonValue               : json string
-QJsonObject              : <empty>
-QJsonArray               : <empty>
-QJsonDocument            : <empty>
-
-=== CBOR Types ===
-QCborValue               : cbor string
-QCborArray               : <empty>
-QCborMap                 : <empty>
-QCborSimpleType          : 21
-
-=== XML Types ===
-QDomElement              : <empty>
-
-=== Special Types ===
-Nullptr                  : <empty>
-Invalid                  : <empty>
-Null QString             : <empty>
-QObjectStar              : <empty>*/
+// With limits in place of the defaults (see RenderLimits)
+template <AppendsToQString T>
+inline void
+appendQString(QString& out, const T& value, const RenderLimits& limits)
+{
+    Internal::RenderLimitsScope_ scope(limits);
+    appendQString(out, value);
+}
+
+template <AppendsToQString T>
+inline QString toQString(const T& value, const RenderLimits& limits)
+{
+    QString out{};
+    appendQString(out, value, limits);
+    return out;
+}
+
+// --- Renderer registry ---
+
+// Registers appendQString for T (reading the variant's storage in place):
+//
+// registerQStringRenderer<Coco::Path>();
+template <typename T> inline void registerQStringRenderer()
+{
+    registerQStringRenderer(
+        QMetaType::fromType<T>(),
+        [](QString& out, const QVariant& variant) {
+            appendQString(out, *static_cast<const T*>(variant.constData()));
+        });
+}
+
+} // namespace Coco
@@ -0,0 +1,207 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QStringList>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+// Lazy counterpart to paths(): entries are listed one directory at a time, as
+// the range is iterated, so the first match costs only the directories read to
+// reach it, and breaking out of the loop stops the walk (nothing is listed
+// ahead, and nothing is collected)
+//
+// Entries come depth-first, each directory before its contents, filtered as
+// QDirIterator filters them (except that "." and ".." are never listed):
+//
+// for (auto& path : Coco::walk(
+//          project,
+//          { .filters = QDir::Files,
+//            .prune = [](const Coco::Path& dir) {
+//                return dir.nameView() == u"node_modules";
+//            } })) {
+//     if (path.extView() == u".pro")
+//         return path; // Done, nothing else is read
+// }
+//
+// walkEntries yields DirEntry values instead, which answer isFile() and the
+// like (and, with WalkOptions::stat, size() and lastModified()) without
+// touching the disk again
+namespace Coco {
+
+namespace Internal {
+
+struct WalkState;
+
+} // namespace Internal
+
+struct WalkOptions
+{
+    // Provide extensions as: `{ "*.mp3", "*.wav" }`
+    QStringList exts{};
+    QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot;
+    QDirIterator::IteratorFlags flags = QDirIterator::Subdirectories;
+
+    // How many levels below the starting directory to enter (0 lists its
+    // direct contents without descending, -1 for no limit). Needs
+    // Subdirectories
+    int maxDepth = -1;
+
+    // Called for each directory about to be entered; return true to skip its
+    // contents (the directory itself is still listed, if it matches)
+    std::function<bool(const Path&)> prune{};
+
+    // Also capture each entry's size, mtime and permissions (one stat per
+    // entry listed, where the type alone costs none on most filesystems)
+    bool stat = false;
+};
+
+// Yields each entry's Path (Walk) or its whole DirEntry (EntryWalk)
+template <typename T> class BasicWalk
+{
+public:
+    // Single-pass: every iterator shares the walk's position
+    class Iterator
+    {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        const T& operator*() const noexcept { return walk_->value_(); }
+        const T* operator->() const noexcept { return &walk_->value_(); }
+
+        Iterator& operator++()
+        {
+            walk_->advance_();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const noexcept
+        {
+            return !walk_ || walk_->done_;
+        }
+
+    private:
+        friend class BasicWalk;
+
+        explicit Iterator(BasicWalk* walk)
+            : walk_(walk)
+        {
+        }
+
+        BasicWalk* walk_ = nullptr;
+    };
+
+    explicit BasicWalk(const Path& dir, WalkOptions options = {});
+    ~BasicWalk();
+
+    BasicWalk(BasicWalk&&) noexcept;
+    BasicWalk& operator=(BasicWalk&&) noexcept;
+
+    // The first entry is read here, not on construction
+    Iterator begin()
+    {
+        if (!started_) {
+            started_ = true;
+            advance_();
+        }
+
+        return Iterator(this);
+    }
+
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+    // The current entry, with all that was learned listing it
+    const DirEntry& entry() const noexcept { return entry_; }
+
+    // Levels below the starting directory of the current entry (0 for its
+    // own contents)
+    int depth() const noexcept { return depth_; }
+
+private:
+    std::unique_ptr<Internal::WalkState> state_;
+    DirEntry entry_{};
+    int depth_ = 0;
+    bool started_ = false;
+    bool done_ = false;
+
+    const T& value_() const noexcept
+    {
+        if constexpr (std::is_same_v<T, DirEntry>)
+            return entry_;
+        else
+            return entry_.path();
+    }
+
+    void advance_();
+};
+
+// Both instantiated in Walk.cpp
+extern template class BasicWalk<Path>;
+extern template class BasicWalk<DirEntry>;
+
+using Walk = BasicWalk<Path>;
+using EntryWalk = BasicWalk<DirEntry>;
+
+inline Walk walk(const Path& dir, WalkOptions options = {})
+{
+    return Walk(dir, std::move(options));
+}
+
+inline Walk walk(
+    const Path& dir,
+    QDir::Filters filters,
+    QDirIterator::IteratorFlags flags = QDirIterator::Subdirectories)
+{
+    return Walk(dir, { .filters = filters, .flags = flags });
+}
+
+inline EntryWalk walkEntries(const Path& dir, WalkOptions options = {})
+{
+    return EntryWalk(dir, std::move(options));
+}
+
+// As paths(), but each entry comes with its type, size, mtime and permissions,
+// all captured while listing
+
+// Provide extensions as: `{ "*.mp3", "*.wav" }`
+DirEntryList dirEntries(
+    const Path& dir,
+    const QStringList& exts,
+    QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot,
+    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
+
+inline DirEntryList dirEntries(
+    const Path& dir,
+    QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot,
+    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags)
+{
+    return dirEntries(dir, {}, filters, flags);
+}
+
+} // namespace Coco
@@ -0,0 +1,369 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+// Coco logging benchmark.
+//
+// Measures LOG call cost (per-call latency percentiles) and end-to-end
+// throughput into the log file, in sync, async and structured mode, across 1
+// to 64 producer threads. Prints a table, or JSON/CSV for tracking regressions
+// between revisions:
+//   CocoBench --format json --output bench.json
+//   CocoBench --format csv --calls 100000 --max-threads 16
+//
+// Qt's own handler (console output) is swapped for a no-op before Coco chains
+// to it, so only the file is measured. Modes are one-way (startAsync can't be
+// undone), so the scenarios always run in the same order
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtLogging>
+#include <QtTypes>
+
+#include <Coco/Debug.h>
+#include <Coco/Path.h>
+
+using namespace Qt::StringLiterals;
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    QString name{};
+    QString mode{};
+    int threads = 1;
+    qint64 calls = 0;
+    double seconds = 0.0;
+    qint64 bytes = 0;
+    double meanNs = 0.0;
+    qint64 p50Ns = 0;
+    qint64 p99Ns = 0;
+    qint64 p999Ns = 0;
+};
+
+static QString logDir{};
+static qint64 timerOverhead = 0;
+
+static void
+discardMessage(QtMsgType, const QMessageLogContext&, const QString&)
+{
+}
+
+static qint64 nanos(Clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+        .count();
+}
+
+// Cost of an empty Clock::now() pair, taken off every sample
+static qint64 measureTimerOverhead()
+{
+    std::vector<qint64> samples(100000);
+
+    for (auto& sample : samples) {
+        auto begin = Clock::now();
+        auto end = Clock::now();
+        sample = nanos(end - begin);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static qint64 logBytes()
+{
+    qint64 total = 0;
+    auto entries = QDir(logDir).entryInfoList(QDir::Files);
+
+    for (auto& entry : entries)
+        total += entry.size();
+
+    return total;
+}
+
+// Sorted samples
+static qint64 percentile(const std::vector<qint64>& samples, double p)
+{
+    if (samples.empty())
+        return 0;
+
+    auto rank = static_cast<qsizetype>(std::ceil(p * samples.size()));
+    auto index = std::clamp<qsizetype>(rank - 1, 0, samples.size() - 1);
+    return samples[index];
+}
+
+// Runs fn(i) callsPerThread times on each of threads threads, timing every
+// call. Wall time runs from the starting line to Debug::flush returning, so in
+// async mode it includes draining the queue
+template <typename FnT>
+static Result run(
+    const QString& name,
+    const QString& mode,
+    int threads,
+    qint64 callsPerThread,
+    FnT fn)
+{
+    std::vector<std::vector<qint64>> samples(threads);
+    std::vector<std::thread> workers{};
+    std::latch ready(threads + 1);
+
+    Coco::Debug::flush();
+    auto bytes_before = logBytes();
+
+    for (auto t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            auto& out = samples[t];
+            out.reserve(callsPerThread);
+            ready.arrive_and_wait();
+
+            for (qint64 i = 0; i < callsPerThread; ++i) {
+                auto begin = Clock::now();
+                fn(i);
+                auto end = Clock::now();
+                out.push_back(std::max<qint64>(
+                    nanos(end - begin) - timerOverhead,
+                    0));
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto begin = Clock::now();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    Coco::Debug::flush();
+    auto end = Clock::now();
+
+    std::vector<qint64> all{};
+    all.reserve(threads * callsPerThread);
+
+    for (auto& thread_samples : samples)
+        all.insert(all.end(), thread_samples.begin(), thread_samples.end());
+
+    std::sort(all.begin(), all.end());
+
+    Result result{};
+    result.name = name;
+    result.mode = mode;
+    result.threads = threads;
+    result.calls = static_cast<qint64>(all.size());
+    result.seconds = std::chrono::duration<double>(end - begin).count();
+    result.bytes = logBytes() - bytes_before;
+
+    double sum = 0.0;
+    for (auto sample : all)
+        sum += sample;
+
+    result.meanNs = all.empty() ? 0.0 : sum / all.size();
+    result.p50Ns = percentile(all, 0.50);
+    result.p99Ns = percentile(all, 0.99);
+    result.p999Ns = percentile(all, 0.999);
+
+    return result;
+}
+
+static double perSecond(double value, double seconds)
+{
+    return seconds > 0.0 ? value / seconds : 0.0;
+}
+
+static void writeTable(QTextStream& out, const QList<Result>& results)
+{
+    out << Qt::left << qSetFieldWidth(16) << "name" << qSetFieldWidth(12)
+        << "mode" << qSetFieldWidth(8) << "threads" << qSetFieldWidth(12)
+        << "mean ns" << "p50 ns" << "p99 ns" << "p999 ns" << qSetFieldWidth(14)
+        << "calls/s" << "MB/s" << qSetFieldWidth(0) << Qt::endl;
+
+    for (auto& r : results) {
+        out << qSetFieldWidth(16) << r.name << qSetFieldWidth(12) << r.mode
+            << qSetFieldWidth(8) << r.threads << qSetFieldWidth(12)
+            << QString::number(r.meanNs, 'f', 1) << r.p50Ns << r.p99Ns
+            << r.p999Ns << qSetFieldWidth(14)
+            << QString::number(perSecond(r.calls, r.seconds), 'f', 0)
+            << QString::number(perSecond(r.bytes, r.seconds) / 1e6, 'f', 2)
+            << qSetFieldWidth(0) << Qt::endl;
+    }
+}
+
+static void writeCsv(QTextStream& out, const QList<Result>& results)
+{
+    out << "name,mode,threads,calls,seconds,bytes,mean_ns,p50_ns,p99_ns,"
+           "p999_ns,calls_per_sec,bytes_per_sec\n";
+
+    for (auto& r : results) {
+        out << r.name << ',' << r.mode << ',' << r.threads << ',' << r.calls
+            << ',' << QString::number(r.seconds, 'f', 6) << ',' << r.bytes
+            << ',' << QString::number(r.meanNs, 'f', 1) << ',' << r.p50Ns
+            << ',' << r.p99Ns << ',' << r.p999Ns << ','
+            << QString::number(perSecond(r.calls, r.seconds), 'f', 0) << ','
+            << QString::number(perSecond(r.bytes, r.seconds), 'f', 0)
+            << '\n';
+    }
+}
+
+static void writeJson(QTextStream& out, const QList<Result>& results)
+{
+    QJsonArray array{};
+
+    for (auto& r : results) {
+        array.append(QJsonObject{
+            { u"name"_s, r.name },
+            { u"mode"_s, r.mode },
+            { u"threads"_s, r.threads },
+            { u"calls"_s, r.calls },
+            { u"seconds"_s, r.seconds },
+            { u"bytes"_s, r.bytes },
+            { u"mean_ns"_s, r.meanNs },
+            { u"p50_ns"_s, r.p50Ns },
+            { u"p99_ns"_s, r.p99Ns },
+            { u"p999_ns"_s, r.p999Ns },
+            { u"calls_per_sec"_s, perSecond(r.calls, r.seconds) },
+            { u"bytes_per_sec"_s, perSecond(r.bytes, r.seconds) },
+        });
+    }
+
+    QJsonObject root{
+        { u"coco_version"_s, QString::fromUtf8(COCO_BENCH_VERSION) },
+        { u"qt_version"_s, QString::fromUtf8(qVersion()) },
+        { u"hardware_threads"_s,
+          static_cast<int>(std::thread::hardware_concurrency()) },
+        { u"timer_overhead_ns"_s, timerOverhead },
+        { u"results"_s, array },
+    };
+
+    out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser{};
+    parser.setApplicationDescription(u"Coco logging benchmark"_s);
+    parser.addHelpOption();
+
+    QCommandLineOption format_option(
+        u"format"_s,
+        u"Output format: table, json or csv"_s,
+        u"format"_s,
+        u"table"_s);
+    QCommandLineOption output_option(
+        u"output"_s,
+        u"Write results to this file instead of stdout"_s,
+        u"file"_s);
+    QCommandLineOption calls_option(
+        u"calls"_s,
+        u"Log calls per scenario, split across its threads"_s,
+        u"n"_s,
+        u"200000"_s);
+    QCommandLineOption threads_option(
+        u"max-threads"_s,
+        u"Highest producer thread count (doubling from 1)"_s,
+        u"n"_s,
+        u"64"_s);
+
+    parser.addOptions(
+        { format_option, output_option, calls_option, threads_option });
+    parser.process(app);
+
+    auto format = parser.value(format_option);
+    auto total_calls = qMax(parser.value(calls_option).toLongLong(), 1LL);
+    auto max_threads = qMax(parser.value(threads_option).toInt(), 1);
+
+    QTemporaryDir tmp{};
+    logDir = tmp.path();
+    timerOverhead = measureTimerOverhead();
+
+    qInstallMessageHandler(discardMessage);
+    Coco::Debug::init(true, Coco::Path(logDir), u"bench"_s, 0);
+
+    QList<int> thread_counts{};
+    for (auto n = 1; n <= max_threads; n *= 2)
+        thread_counts << n;
+
+    QList<Result> results{};
+
+    auto log_info = [](qint64 i) {
+        INFO("bench {} {} {}", i, 3.14159, u"payload"_s);
+    };
+
+    auto log_debug = [](qint64 i) {
+        DEBUG("bench {} {} {}", i, 3.14159, u"payload"_s);
+    };
+
+    // Call cost: a disabled level (one relaxed load), then enabled
+    Coco::Debug::setLogRules(u"default=info");
+    results << run(u"debug_disabled"_s, u"sync"_s, 1, total_calls, log_debug);
+    Coco::Debug::setLogRules({});
+    results << run(u"debug_enabled"_s, u"sync"_s, 1, total_calls, log_debug);
+    results << run(u"info_enabled"_s, u"sync"_s, 1, total_calls, log_info);
+
+    // Throughput: producers contending for the handler, then for the queue
+    auto contended = [&](const QString& mode) {
+        for (auto threads : thread_counts) {
+            auto calls = qMax(total_calls / threads, 1000LL);
+            results << run(u"info_threads"_s, mode, threads, calls, log_info);
+        }
+    };
+
+    contended(u"sync"_s);
+
+    Coco::Debug::startAsync();
+    contended(u"async"_s);
+
+    Coco::Debug::setStructured(true);
+    contended(u"structured"_s);
+
+    QFile file{};
+    QTextStream out(stdout);
+
+    if (parser.isSet(output_option)) {
+        file.setFileName(parser.value(output_option));
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream(stderr)
+                << "Can't write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+
+        out.setDevice(&file);
+    }
+
+    if (format == u"json")
+        writeJson(out, results);
+    else if (format == u"csv")
+        writeCsv(out, results);
+    else
+        writeTable(out, results);
+
+    out.flush();
+    return 0;
+}
@@ -13,9 +13,16 @@
 #include "Coco/Debug.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <QByteArray>
 #include <QFile>
@@ -23,51 +30,180 @@
 #include <QMessageLogContext>
 #include <QMessageLogger>
 #include <QObject>
+#include <QSaveFile>
 #include <QString>
+#include <QStringEncoder>
+#include <QStringView>
+#include <QStringList>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QVarLengthArray>
 #include <QtLogging>
 
 #include "Coco/Disk.h"
 #include "Coco/Fmt.h"
+#include "Coco/LogCategory.h"
+#include "Coco/LogRecord.h"
+#include "Coco/LogSink.h"
 #include "Coco/Path.h"
 #include "Coco/Time.h"
 
+#include "LogQueue.h"
+
 namespace Coco::Debug {
 
 namespace {
 
-constexpr auto VOC_FORMAT_ = u"In {}: {}";
-constexpr auto MSG_FORMAT_ = u"{} | {} | {}";
+constexpr char16_t VOC_FORMAT_[] = u"In {}: {}";
+constexpr char16_t MSG_FORMAT_[] = u"{} | {} | {}";
 auto LOG_EXT_ = u".log"_s;
+auto COMPRESSED_EXT_ = u".qz"_s;
+constexpr auto WRITER_BATCH_ = 256;
+constexpr auto UTF8_STACK_SIZE_ = 1024;
 
 std::atomic<QtMsgType> minimumLevel_{ QtFatalMsg };
 std::atomic<uint64_t> logEntryCount_{ 0 };
 Path logDir_{};
 QString logPrefix_{};
+int logCap_ = 0;
+Rotation rotation_{};
+
+// mutex_ guards configuration (directory, prefix, rotation). fileMutex_
+// guards the file, the stream and the rotation triggers, and is the one held
+// across disk I/O. Keeping them apart
+// means a producer in async mode never waits on the writer's batch
 std::mutex mutex_{};
-QFile logFile_{};
+std::mutex fileMutex_{};
+std::unique_ptr<QFile> logFile_{};
 QTextStream logStream_{};
-LogSink logSink_{};
-QtMessageHandler qtHandler_ = nullptr;
+// Position in the current file to rotate at (0 for never), and when
+qint64 rotateAtBytes_ = 0;
+std::chrono::system_clock::time_point rotateAt_ =
+    std::chrono::system_clock::time_point::max();
+std::atomic<bool> rotating_{ false };
+std::atomic<QtMessageHandler> qtHandler_{ nullptr };
+std::atomic<quint64> droppedCount_{ 0 };
+std::atomic<bool> structured_{ false };
+
+// Set while Log::dispatch_ hands a line to Qt. Log already filtered it by its
+// category (which may be more verbose than minimumLevel_), so handler_ must not
+// filter it again
+thread_local bool prefiltered_ = false;
+
+// Reused by handler_ for sync-mode lines, so a steady stream of them stops
+// allocating once it has grown to fit. A nested call on the same thread (a
+// sink or Qt handler that logs) formats into a fresh string instead
+thread_local QString lineBuffer_{};
+thread_local bool lineBufferBusy_ = false;
+
+const auto startTime_ = std::chrono::steady_clock::now();
+std::atomic<TimestampClock> timestampClock_{ TimestampClock::Wall };
+
+void putDigits_(char16_t* out, qint64 value, int width)
+{
+    for (auto i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char16_t>(u'0' + value % 10);
+        value /= 10;
+    }
+}
 
-QString timestamp_()
+// One per thread, so no locking. Everything up to the fractional digits only
+// changes once a second, so that prefix is rebuilt when the second rolls over
+// and the rest of the time only the last few digits are patched in place
+class TimestampCache_
 {
-    auto now = Time::now();
-    auto days = std::chrono::floor<std::chrono::days>(now.seconds);
-    std::chrono::year_month_day ymd{ days };
-    std::chrono::hh_mm_ss hms{ now.seconds - days };
+public:
+    // The view points into this thread's buffer and is only good until the
+    // thread's next call
+    QStringView render(qint64 nsecs, TimestampClock clock)
+    {
+        using namespace std::chrono;
+
+        auto total = nanoseconds{ nsecs };
+        auto secs = floor<seconds>(total);
+        auto fraction = total - secs;
+
+        if (secs.count() != second_ || clock != clock_) {
+            second_ = secs.count();
+            clock_ = clock;
+            prefixSize_ = clock == TimestampClock::Wall
+                              ? wallPrefix_(secs)
+                              : monotonicPrefix_(secs);
+        }
 
-    return QString::asprintf(
-        "%04d-%02d-%02d | %02d:%02d:%02d.%03d",
-        static_cast<int>(ymd.year()),
-        static_cast<unsigned>(ymd.month()),
-        static_cast<unsigned>(ymd.day()),
-        static_cast<int>(hms.hours().count()),
-        static_cast<int>(hms.minutes().count()),
-        static_cast<int>(hms.seconds().count()),
-        static_cast<int>(now.milliseconds));
+        auto digits = clock == TimestampClock::Wall ? 3 : 6;
+        auto units = clock == TimestampClock::Wall
+                         ? duration_cast<milliseconds>(fraction).count()
+                         : duration_cast<microseconds>(fraction).count();
+
+        putDigits_(buffer_ + prefixSize_, units, digits);
+        return { buffer_, prefixSize_ + digits };
+    }
+
+private:
+    qint64 second_ = std::numeric_limits<qint64>::min();
+    TimestampClock clock_ = TimestampClock::Wall;
+    qsizetype prefixSize_ = 0;
+    char16_t buffer_[32]{};
+
+    // "YYYY-MM-DD | HH:MM:SS." Like Time::now(), epoch seconds are taken as
+    // local_seconds, so this matches what the logger has always printed
+    qsizetype wallPrefix_(std::chrono::seconds secs)
+    {
+        using namespace std::chrono;
+
+        local_seconds local{ secs };
+        auto day = floor<days>(local);
+        year_month_day ymd{ day };
+        hh_mm_ss hms{ local - day };
+
+        auto out = buffer_;
+        putDigits_(out, static_cast<int>(ymd.year()), 4);
+        out[4] = u'-';
+        putDigits_(out + 5, static_cast<unsigned>(ymd.month()), 2);
+        out[7] = u'-';
+        putDigits_(out + 8, static_cast<unsigned>(ymd.day()), 2);
+        out[10] = u' ';
+        out[11] = u'|';
+        out[12] = u' ';
+        putDigits_(out + 13, hms.hours().count(), 2);
+        out[15] = u':';
+        putDigits_(out + 16, hms.minutes().count(), 2);
+        out[18] = u':';
+        putDigits_(out + 19, hms.seconds().count(), 2);
+        out[21] = u'.';
+
+        return 22;
+    }
+
+    // "+SSSSSS." (seconds since startup, at least six digits)
+    qsizetype monotonicPrefix_(std::chrono::seconds secs)
+    {
+        auto value = secs.count();
+        auto width = 1;
+
+        for (auto rest = value / 10; rest > 0; rest /= 10)
+            ++width;
+
+        width = qMax(width, 6);
+        buffer_[0] = u'+';
+        putDigits_(buffer_ + 1, value, width);
+        buffer_[width + 1] = u'.';
+
+        return width + 2;
+    }
+};
+
+QStringView timestamp_(qint64 nsecs)
+{
+    thread_local TimestampCache_ cache{};
+    return cache.render(
+        nsecs,
+        timestampClock_.load(std::memory_order::relaxed));
 }
 
+QStringView timestamp_() { return timestamp_(timestampNow()); }
+
 QString logFileName_()
 {
     auto now = Time::now();
@@ -88,35 +224,465 @@ QString logFileName_()
                                 : logPrefix_ + "_" + timestamp + LOG_EXT_;
 }
 
+std::chrono::system_clock::time_point nextBoundary_(RotateEvery every)
+{
+    using namespace std::chrono;
+
+    // Same convention as the file names: epoch-aligned hours and days
+    auto now = system_clock::now();
+
+    switch (every) {
+    case RotateEvery::Hour:
+        return floor<hours>(now) + hours{ 1 };
+    case RotateEvery::Day:
+        return floor<days>(now) + days{ 1 };
+    default:
+    case RotateEvery::Never:
+        return system_clock::time_point::max();
+    }
+}
+
+// Rotation can land twice in the same second, so the new name may already be
+// taken (by the live file or a compressed segment). Call with mutex_ held
+Path segmentPath_()
+{
+    auto name = logFileName_();
+    auto path = logDir_ / name;
+    auto base = name.chopped(LOG_EXT_.size());
+
+    auto taken = [](const Path& path) {
+        return path.exists() ||
+               Path(path.toQString() + COMPRESSED_EXT_).exists();
+    };
+
+    for (auto i = 1; taken(path); ++i)
+        path = logDir_ / (base + u"_"_s + QString::number(i) + LOG_EXT_);
+
+    return path;
+}
+
+void pruneLogs_(const Path& dir, const QString& prefix, int cap, qint64 budget)
+{
+    Disk::prune(
+        dir,
+        prefix,
+        QStringList{ LOG_EXT_, LOG_EXT_ + COMPRESSED_EXT_ },
+        cap,
+        budget);
+}
+
+// Replaces path with "<path>.qz" (only once the compressed copy is safely on
+// disk). Segments are capped by Rotation::maxBytes, so reading one whole is
+// fine
+void compress_(const QString& path)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly))
+        return;
+
+    auto data = qCompress(in.readAll());
+    in.close();
+
+    QSaveFile out(path + COMPRESSED_EXT_);
+    if (!out.open(QIODevice::WriteOnly))
+        return;
+
+    out.write(data);
+    if (out.commit())
+        QFile::remove(path);
+}
+
+// Call with fileMutex_ held, right after a write. The rotation itself happens
+// in rotate_, after the lock is released
+bool rotationDue_()
+{
+    if (!logFile_)
+        return false;
+    if (rotateAtBytes_ > 0 && logFile_->pos() >= rotateAtBytes_)
+        return true;
+
+    return rotateAt_ != std::chrono::system_clock::time_point::max() &&
+           std::chrono::system_clock::now() >= rotateAt_;
+}
+
+// Opens the next segment with no lock held, swaps it in under fileMutex_ (a
+// flush and a pointer swap), then hands the old file to the thread pool
+void rotate_()
+{
+    // One rotation at a time. Anyone else who saw it due keeps writing to the
+    // current file, which is fine
+    if (rotating_.exchange(true, std::memory_order::acquire))
+        return;
+
+    Path dir{};
+    QString prefix{};
+    Path path{};
+    auto cap = 0;
+    Rotation rotation{};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dir = logDir_;
+        prefix = logPrefix_;
+        cap = logCap_;
+        rotation = rotation_;
+        path = segmentPath_();
+    }
+
+    auto file = std::make_unique<QFile>(path.toQString());
+
+    // Keep writing to the old file, and try again at the next boundary (or
+    // once it grows by another maxBytes)
+    auto opened = file->open(QIODevice::WriteOnly | QIODevice::Text);
+    std::unique_ptr<QFile> old{};
+
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        rotateAt_ = nextBoundary_(rotation.every);
+
+        if (opened) {
+            logStream_.flush();
+            logStream_.setDevice(file.get());
+            old = std::exchange(logFile_, std::move(file));
+            rotateAtBytes_ = rotation.maxBytes;
+        } else if (logFile_ && rotation.maxBytes > 0) {
+            rotateAtBytes_ = logFile_->pos() + rotation.maxBytes;
+        }
+    }
+
+    rotating_.store(false, std::memory_order::release);
+
+    if (!old)
+        return;
+
+    auto old_path = old->fileName();
+    auto compress = rotation.compress;
+    auto budget = rotation.budgetBytes;
+
+    // Closing flushes and can block on the disk, so it goes too. Captures are
+    // by value: the task may outlive a later init or setRotation
+    QThreadPool::globalInstance()->start(
+        [old = std::shared_ptr<QFile>(std::move(old)),
+         old_path,
+         compress,
+         dir,
+         prefix,
+         cap,
+         budget] {
+            old->close();
+            if (compress)
+                compress_(old_path);
+            pruneLogs_(dir, prefix, cap, budget);
+        });
+}
+
+// A queued log line. Structured entries carry the Record instead, and the
+// writer renders their line
+struct Entry_
+{
+    QString line{};
+    Record record{};
+    bool structured = false;
+};
+
+// Message text for a Record, with the same "In Class(ptr): " prefix that
+// Log::dispatch_ adds for a QObject context
+QString message_(const Record& record)
+{
+    auto msg = record.render();
+
+    if (record.className) {
+        auto obj = QString::asprintf("%s(%p)", record.className, record.object);
+        msg = Fmt::format(VOC_FORMAT_, obj, msg);
+    }
+
+    return msg;
+}
+
+QString renderLine_(const Record& record)
+{
+    auto stamp = timestamp_(record.nsecs);
+    return Fmt::format(MSG_FORMAT_, record.count, stamp, message_(record));
+}
+
+// What handler_ does after the file write, for records that never went
+// through Qt's handler chain
+void deliver_(const Record& record, const QString& line)
+{
+    Internal::fanOut_(record.type, line);
+
+    if (auto qt_handler = qtHandler_.load(std::memory_order::acquire)) {
+        QMessageLogContext context(
+            record.file,
+            record.line,
+            record.function,
+            record.category ? record.category : "default");
+        qt_handler(record.type, context, line);
+    }
+}
+
+// Owns the queue and the thread that drains it into logStream_
+class AsyncWriter_
+{
+public:
+    AsyncWriter_(std::size_t capacity, Overflow overflow)
+        : queue_(capacity)
+        , overflow_(overflow)
+    {
+        thread_ = std::thread([this] { run_(); });
+    }
+
+    ~AsyncWriter_()
+    {
+        stopping_.store(true, std::memory_order::release);
+        wake_();
+
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void push(Entry_& entry)
+    {
+        // If writing to the file makes Qt warn, that warning comes back through
+        // handler_ on the writer thread. Waiting on ourselves would deadlock
+        auto policy = std::this_thread::get_id() == thread_.get_id()
+                          ? Overflow::DropAndCount
+                          : overflow_;
+
+        switch (policy) {
+        case Overflow::Block:
+            pushBlocking_(entry);
+            break;
+
+        case Overflow::DropOldest:
+            while (!queue_.tryPush(entry)) {
+                Entry_ evicted{};
+                if (queue_.tryPop(evicted))
+                    droppedCount_.fetch_add(1, std::memory_order::relaxed);
+            }
+            break;
+
+        case Overflow::DropAndCount:
+            if (!queue_.tryPush(entry)) {
+                droppedCount_.fetch_add(1, std::memory_order::relaxed);
+                return;
+            }
+            break;
+        }
+
+        wake_();
+    }
+
+    // A fatal line is the last word before Qt aborts, so it's never dropped:
+    // other threads wait for room and then for the write. The writer thread
+    // can't wait on itself, so it writes the line straight to the file
+    void pushFatal(Entry_& entry)
+    {
+        if (std::this_thread::get_id() != thread_.get_id()) {
+            pushBlocking_(entry);
+            flush();
+            return;
+        }
+
+        // Unless it came from inside that write (this thread holds the lock,
+        // and the stream is mid-line). Qt aborts before the batch could finish,
+        // so it goes to stderr instead
+        if (writing_) {
+            std::fputs(qUtf8Printable(entry.line + u'\n'), stderr);
+            std::fflush(stderr);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(fileMutex_);
+
+        if (logStream_.device()) {
+            logStream_ << entry.line << '\n';
+            logStream_.flush();
+        }
+    }
+
+    void flush()
+    {
+        auto target = queue_.pushed();
+        wake_();
+
+        auto written = written_.load(std::memory_order::acquire);
+
+        while (written < target) {
+            written_.wait(written, std::memory_order::acquire);
+            written = written_.load(std::memory_order::acquire);
+        }
+    }
+
+private:
+    Internal::LogQueue<Entry_> queue_;
+    Overflow overflow_;
+    std::thread thread_{};
+    std::atomic<bool> stopping_{ false };
+
+    // Bumped by producers after every push; the writer sleeps on it
+    std::atomic<quint32> signal_{ 0 };
+
+    // Queue position the writer has caught up to (written, or evicted by a
+    // DropOldest producer). flush() and blocked producers sleep on it
+    std::atomic<std::size_t> written_{ 0 };
+
+    // Set by the writer thread (and read only by it) while it holds fileMutex_
+    bool writing_ = false;
+
+    void wake_()
+    {
+        signal_.fetch_add(1, std::memory_order::release);
+        signal_.notify_one();
+    }
+
+    void pushBlocking_(Entry_& entry)
+    {
+        while (!queue_.tryPush(entry)) {
+            auto written = written_.load(std::memory_order::acquire);
+            wake_();
+            if (queue_.tryPush(entry))
+                break;
+            written_.wait(written, std::memory_order::acquire);
+        }
+    }
+
+    void run_()
+    {
+        std::vector<Entry_> batch(WRITER_BATCH_);
+
+        while (true) {
+            auto seen = signal_.load(std::memory_order::acquire);
+            auto count = 0;
+
+            while (count < WRITER_BATCH_ && queue_.tryPop(batch[count]))
+                ++count;
+
+            for (auto i = 0; i < count; ++i) {
+                auto& entry = batch[i];
+                if (entry.structured)
+                    entry.line = renderLine_(entry.record);
+            }
+
+            auto rotate = false;
+
+            if (count) {
+                std::lock_guard<std::mutex> lock(fileMutex_);
+                writing_ = true;
+
+                if (logStream_.device()) {
+                    for (auto i = 0; i < count; ++i)
+                        logStream_ << batch[i].line << '\n';
+                    logStream_.flush();
+                    rotate = rotationDue_();
+                }
+
+                writing_ = false;
+            }
+
+            if (rotate)
+                rotate_();
+
+            for (auto i = 0; i < count; ++i) {
+                auto& entry = batch[i];
+                if (entry.structured)
+                    deliver_(entry.record, entry.line);
+            }
+
+            // Publish even when nothing was written: DropOldest producers can
+            // empty the queue themselves, and flush() still needs to see it
+            written_.store(queue_.popped(), std::memory_order::release);
+            written_.notify_all();
+
+            if (count)
+                continue;
+            if (stopping_.load(std::memory_order::acquire))
+                break;
+
+            signal_.wait(seen, std::memory_order::acquire);
+        }
+    }
+};
+
+std::unique_ptr<AsyncWriter_> asyncWriter_{};
+std::atomic<AsyncWriter_*> async_{ nullptr };
+
+// Defined after logFile_/logStream_, so static destruction stops the writer
+// (which writes out whatever is left) before the file goes away. Unpublish
+// first so late log calls fall back to the sync path
+struct AsyncWriterGuard_
+{
+    ~AsyncWriterGuard_()
+    {
+        async_.store(nullptr, std::memory_order::release);
+        asyncWriter_.reset();
+    }
+} asyncWriterGuard_{};
+
 void handler_(
     QtMsgType type,
     const QMessageLogContext& context,
     const QString& msg)
 {
-    if (severity(type) <
-        severity(minimumLevel_.load(std::memory_order::relaxed))) {
+    auto prefiltered = std::exchange(prefiltered_, false);
+
+    if (!prefiltered &&
+        severity(type) <
+            severity(minimumLevel_.load(std::memory_order::relaxed))) {
         return;
     }
 
     auto count = logEntryCount_.fetch_add(1, std::memory_order::relaxed);
-    auto new_msg = Fmt::format(MSG_FORMAT_, count, timestamp_(), msg);
+    auto writer = async_.load(std::memory_order::acquire);
+
+    // Queued lines are kept a while, so they're sized exactly. Others only
+    // need to live until this returns (sinks and handlers that keep one get a
+    // shallow copy, which the next resize detaches from)
+    QString queued_msg{};
+    auto reuse = !writer && !std::exchange(lineBufferBusy_, true);
+    auto& new_msg = reuse ? lineBuffer_ : queued_msg;
+
+    if (writer) {
+        new_msg = Fmt::formatExact(MSG_FORMAT_, count, timestamp_(), msg);
+    } else {
+        new_msg.resize(0);
+        Fmt::formatTo(new_msg, MSG_FORMAT_, count, timestamp_(), msg);
+    }
 
-    QtMessageHandler qt_handler = nullptr;
-    LogSink log_sink{};
+    auto qt_handler = qtHandler_.load(std::memory_order::acquire);
 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        qt_handler = qtHandler_;
-        log_sink = logSink_;
+    if (writer) {
+        // Shallow copy (the queue takes ownership of it)
+        Entry_ entry{ new_msg };
 
-        if (logStream_.device())
-            logStream_ << new_msg << Qt::endl;
+        // Qt aborts as soon as the handler chain returns
+        if (type == QtFatalMsg)
+            writer->pushFatal(entry);
+        else
+            writer->push(entry);
+    } else {
+        auto rotate = false;
+
+        {
+            std::lock_guard<std::mutex> lock(fileMutex_);
+
+            if (logStream_.device()) {
+                logStream_ << new_msg << Qt::endl;
+                rotate = rotationDue_();
+            }
+        }
+
+        if (rotate)
+            rotate_();
     }
 
-    if (log_sink)
-        log_sink(new_msg);
+    Internal::fanOut_(type, new_msg);
+
     if (qt_handler)
         qt_handler(type, context, new_msg);
+
+    if (reuse)
+        lineBufferBusy_ = false;
 }
 
 } // namespace
@@ -127,9 +693,14 @@ void init(
     const QString& logPrefix,
     int logCap)
 {
-    minimumLevel_.store(
-        verbose ? QtDebugMsg : QtInfoMsg,
-        std::memory_order::relaxed);
+    auto level = verbose ? QtDebugMsg : QtInfoMsg;
+    minimumLevel_.store(level, std::memory_order::relaxed);
+    Internal::setBaseFloor_(severity(level));
+
+    if (qEnvironmentVariableIsSet("COCO_LOG_RULES"))
+        setLogRules(qEnvironmentVariable("COCO_LOG_RULES"));
+    else if (qEnvironmentVariableIsSet("COCO_LOG_RULES_FILE"))
+        loadLogRules(qEnvironmentVariable("COCO_LOG_RULES_FILE"));
 
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -137,24 +708,35 @@ void init(
         logDir_ = logDir;
         logPrefix_ = logPrefix;
 
-        auto path = logDir / logFileName_();
-        logFile_.setFileName(path.toQString());
+        logCap_ = logCap;
 
-        if (logFile_.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            logStream_.setDevice(&logFile_);
-            Disk::prune(logDir, logPrefix, LOG_EXT_, logCap);
+        auto file = std::make_unique<QFile>(segmentPath_().toQString());
+        std::lock_guard<std::mutex> file_lock(fileMutex_);
+
+        if (file->open(QIODevice::WriteOnly | QIODevice::Text)) {
+            logStream_.setDevice(file.get());
+            logFile_ = std::move(file);
+            rotateAtBytes_ = rotation_.maxBytes;
+            rotateAt_ = nextBoundary_(rotation_.every);
+            pruneLogs_(logDir, logPrefix, logCap, rotation_.budgetBytes);
             logStream_ << "VERBOSITY: " << (verbose ? "true" : "false")
                        << Qt::endl;
         }
     }
 
-    qtHandler_ = qInstallMessageHandler(handler_);
+    qtHandler_.store(
+        qInstallMessageHandler(handler_),
+        std::memory_order::release);
 }
 
-void setLogSink(LogSink sink)
+void setRotation(const Rotation& rotation)
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    logSink_ = std::move(sink);
+    rotation_ = rotation;
+
+    std::lock_guard<std::mutex> file_lock(fileMutex_);
+    rotateAtBytes_ = qMax<qint64>(rotation.maxBytes, 0);
+    rotateAt_ = nextBoundary_(rotation.every);
 }
 
 QtMsgType minimumLevel() noexcept
@@ -162,22 +744,124 @@ QtMsgType minimumLevel() noexcept
     return minimumLevel_.load(std::memory_order::relaxed);
 }
 
+void startAsync(int capacity, Overflow overflow)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (asyncWriter_)
+        return;
+
+    asyncWriter_ = std::make_unique<AsyncWriter_>(
+        static_cast<std::size_t>(qMax(capacity, 2)),
+        overflow);
+
+    async_.store(asyncWriter_.get(), std::memory_order::release);
+}
+
+void flush()
+{
+    if (auto writer = async_.load(std::memory_order::acquire))
+        writer->flush();
+
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (logStream_.device())
+            logStream_.flush();
+    }
+
+    Internal::flushSinks_();
+}
+
+void setTimestampClock(TimestampClock clock)
+{
+    timestampClock_.store(clock, std::memory_order::relaxed);
+}
+
+qint64 timestampNow() noexcept
+{
+    using namespace std::chrono;
+
+    if (timestampClock_.load(std::memory_order::relaxed) ==
+        TimestampClock::Monotonic) {
+        return duration_cast<nanoseconds>(steady_clock::now() - startTime_)
+            .count();
+    }
+
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch())
+        .count();
+}
+
+quint64 droppedCount() noexcept
+{
+    return droppedCount_.load(std::memory_order::relaxed) +
+           Internal::sinkDropped_();
+}
+
+void setStructured(bool structured)
+{
+    structured_.store(structured, std::memory_order::relaxed);
+}
+
+bool isStructured() noexcept
+{
+    return structured_.load(std::memory_order::relaxed) &&
+           async_.load(std::memory_order::relaxed);
+}
+
+void setRenderLimits(const RenderLimits& limits) noexcept
+{
+    Coco::Internal::setDefaultRenderLimits_(limits);
+}
+
+RenderLimits renderLimits() noexcept
+{
+    return Coco::Internal::defaultRenderLimits_();
+}
+
+void Log::submit_(Record& record) const
+{
+    if (auto writer = async_.load(std::memory_order::acquire)) {
+        record.count = logEntryCount_.fetch_add(1, std::memory_order::relaxed);
+        Entry_ entry{ {}, std::move(record), true };
+        writer->push(entry);
+        return;
+    }
+
+    // Async mode was torn down after the isStructured() check (exit)
+    dispatch_(
+        record.type,
+        record.file,
+        record.line,
+        record.function,
+        nullptr,
+        message_(record));
+}
+
 void Log::dispatch_(
     QtMsgType type,
     const char* file,
     int line,
     const char* function,
     const QObject* obj,
-    QString msg) const
+    QStringView msg) const
 {
     // Right now, VOC_FORMAT_ is the only reason this needs to be in the
     // source file, which is fine, but worth pointing out
-    if (obj)
-        msg = Fmt::format(VOC_FORMAT_, obj, msg);
+    Fmt::SmallString<> voc_msg{};
+
+    if (obj) {
+        Fmt::formatTo(voc_msg, VOC_FORMAT_, obj, msg);
+        msg = voc_msg.view();
+    }
 
-    auto logger = QMessageLogger(file, line, function);
+    auto logger = QMessageLogger(file, line, function, category->name());
     constexpr auto fmt = "%s";
-    auto utf8 = msg.toUtf8();
+
+    // Encoded on the stack too, for the same reason
+    QStringEncoder encoder(QStringConverter::Utf8);
+    QVarLengthArray<char, UTF8_STACK_SIZE_> utf8(
+        encoder.requiredSpace(msg.size()) + 1);
+    *encoder.appendToBuffer(utf8.data(), msg) = '\0';
+    prefiltered_ = true;
 
     switch (type) {
     case QtDebugMsg:
@@ -197,6 +881,8 @@ void Log::dispatch_(
         logger.fatal(fmt, utf8.constData());
         break;
     }
+
+    prefiltered_ = false;
 }
 
 } // namespace Coco::Debug
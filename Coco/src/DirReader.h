@@ -0,0 +1,433 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+// Private to the directory walkers (not installed, not part of the public
+// include tree)
+
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QtTypes>
+
+#ifdef Q_OS_LINUX
+#    include <dirent.h>
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+namespace Coco::Internal {
+
+// One listed entry, typed the way QFileInfo types it: a symlink takes its
+// target's type, so a broken one is neither file nor dir. The rest is only
+// filled in by DirReader::stat
+struct ListedEntry
+{
+    QString name{};
+    bool isFile = false;
+    bool isDir = false;
+    bool isSymLink = false;
+    bool isHidden = false;
+    bool exists = false;
+
+    qint64 size = -1;
+    qint64 modified = 0; // Milliseconds since the epoch
+    QFile::Permissions permissions{};
+
+    // With stat data only if hasStat (stat having succeeded)
+    DirEntry toDirEntry(Path path, bool hasStat) const
+    {
+        DirEntry entry{};
+        entry.path_ = std::move(path);
+        entry.exists_ = exists;
+        entry.isFile_ = isFile;
+        entry.isDir_ = isDir;
+        entry.isSymLink_ = isSymLink;
+        entry.isHidden_ = isHidden;
+
+        if (hasStat) {
+            entry.hasStat_ = true;
+            entry.size_ = size;
+            entry.modified_ = modified;
+            entry.permissions_ = permissions;
+        }
+
+        return entry;
+    }
+};
+
+// Lists one directory (never "." or ".."). On Linux, straight from getdents64
+// on an openat descriptor: the kernel's d_type usually answers "file or dir?"
+// outright, and only symlinks and d_type-less filesystems cost an fstatat
+// (relative to the open directory, so no path walk). Elsewhere, a flat
+// QDirIterator
+class DirReader
+{
+public:
+    explicit DirReader(const QString& dir)
+#ifdef Q_OS_LINUX
+        : fd_(::openat(
+              AT_FDCWD,
+              QFile::encodeName(dir).constData(),
+              O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+        , buffer_(fd_ < 0 ? nullptr : new char[BUFFER_SIZE_])
+#else
+        : it_(dir, QDir::AllEntries | QDir::Hidden | QDir::System |
+                       QDir::NoDotAndDotDot)
+#endif
+    {
+    }
+
+    ~DirReader()
+    {
+#ifdef Q_OS_LINUX
+        if (fd_ >= 0)
+            ::close(fd_);
+#endif
+    }
+
+    DirReader(const DirReader&) = delete;
+    DirReader& operator=(const DirReader&) = delete;
+
+    bool next(ListedEntry& entry)
+    {
+#ifdef Q_OS_LINUX
+
+        while (true) {
+            if (pos_ >= end_) {
+                if (fd_ < 0)
+                    return false;
+
+                auto read = ::syscall(
+                    SYS_getdents64,
+                    fd_,
+                    buffer_.get(),
+                    BUFFER_SIZE_);
+
+                if (read <= 0)
+                    return false;
+
+                pos_ = 0;
+                end_ = read;
+            }
+
+            auto record =
+                reinterpret_cast<const dirent64*>(buffer_.get() + pos_);
+            pos_ += record->d_reclen;
+
+            auto name = record->d_name;
+            if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+                continue;
+
+            name_ = name;
+
+            entry.name = QFile::decodeName(name);
+            entry.isHidden = name[0] == '.';
+            entry.isSymLink = record->d_type == DT_LNK;
+            entry.isFile = record->d_type == DT_REG;
+            entry.isDir = record->d_type == DT_DIR;
+            entry.exists = true;
+
+            if (entry.isSymLink || record->d_type == DT_UNKNOWN)
+                stat_(name, entry);
+
+            return true;
+        }
+
+#else
+
+        if (!it_.hasNext())
+            return false;
+
+        it_.next();
+        auto info = it_.fileInfo();
+        entry.name = info.fileName();
+        entry.isFile = info.isFile();
+        entry.isDir = info.isDir();
+        entry.isSymLink = info.isSymLink();
+        entry.isHidden = info.isHidden();
+        entry.exists = info.exists();
+        return true;
+
+#endif
+    }
+
+    // Checks only the permissions asked for (QDir::Readable, Writable and
+    // Executable), for the entry just returned by next()
+    bool permits(const ListedEntry& entry, QDir::Filters filters) const
+    {
+#ifdef Q_OS_LINUX
+
+        auto mode = 0;
+        if (filters & QDir::Readable)
+            mode |= R_OK;
+        if (filters & QDir::Writable)
+            mode |= W_OK;
+        if (filters & QDir::Executable)
+            mode |= X_OK;
+
+        return ::faccessat(
+                   fd_,
+                   QFile::encodeName(entry.name).constData(),
+                   mode,
+                   0) == 0;
+
+#else
+
+        Q_UNUSED(entry);
+        auto info = it_.fileInfo();
+        return (!(filters & QDir::Readable) || info.isReadable()) &&
+               (!(filters & QDir::Writable) || info.isWritable()) &&
+               (!(filters & QDir::Executable) || info.isExecutable());
+
+#endif
+    }
+
+    // Size, modification time and permissions of the entry just returned by
+    // next(), following symlinks as QFileInfo does. False (and the entry left
+    // as it was) if there's nothing to stat, as for a broken link
+    bool stat(ListedEntry& entry) const
+    {
+#ifdef Q_OS_LINUX
+
+        struct stat info{};
+        if (::fstatat(fd_, name_, &info, 0) != 0)
+            return false;
+
+        entry.size = info.st_size;
+        entry.modified = qint64(info.st_mtim.tv_sec) * 1000 +
+                         info.st_mtim.tv_nsec / 1'000'000;
+        entry.permissions = permissions_(info);
+        return true;
+
+#else
+
+        auto info = it_.fileInfo();
+        if (!info.exists())
+            return false;
+
+        // Already fetched with the listing on Windows (FindNextFile)
+        entry.size = info.size();
+        entry.modified = info.lastModified().toMSecsSinceEpoch();
+        entry.permissions = info.permissions();
+        return true;
+
+#endif
+    }
+
+private:
+#ifdef Q_OS_LINUX
+    static constexpr auto BUFFER_SIZE_ = 32 * 1024;
+
+    int fd_ = -1;
+    std::unique_ptr<char[]> buffer_{};
+    long pos_ = 0;
+    long end_ = 0;
+
+    // The current entry's name, still in buffer_ until the next read
+    const char* name_ = nullptr;
+
+    // The User flags are for the effective user, going by owner and group
+    // (supplementary groups aside), where QFileInfo would ask access()
+    static QFile::Permissions permissions_(const struct stat& info)
+    {
+        QFile::Permissions result{};
+        auto mode = info.st_mode;
+
+        if (mode & S_IRUSR)
+            result |= QFile::ReadOwner;
+        if (mode & S_IWUSR)
+            result |= QFile::WriteOwner;
+        if (mode & S_IXUSR)
+            result |= QFile::ExeOwner;
+        if (mode & S_IRGRP)
+            result |= QFile::ReadGroup;
+        if (mode & S_IWGRP)
+            result |= QFile::WriteGroup;
+        if (mode & S_IXGRP)
+            result |= QFile::ExeGroup;
+        if (mode & S_IROTH)
+            result |= QFile::ReadOther;
+        if (mode & S_IWOTH)
+            result |= QFile::WriteOther;
+        if (mode & S_IXOTH)
+            result |= QFile::ExeOther;
+
+        auto user = ::geteuid() == info.st_uid   ? mode >> 6
+                    : ::getegid() == info.st_gid ? mode >> 3
+                                                 : mode;
+
+        if (user & S_IROTH)
+            result |= QFile::ReadUser;
+        if (user & S_IWOTH)
+            result |= QFile::WriteUser;
+        if (user & S_IXOTH)
+            result |= QFile::ExeUser;
+
+        return result;
+    }
+
+    // For a symlink, or any entry on a filesystem that leaves d_type unset
+    void stat_(const char* name, ListedEntry& entry) const
+    {
+        struct stat info{};
+
+        if (!entry.isSymLink) {
+            if (::fstatat(fd_, name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+                entry.exists = false;
+                return;
+            }
+
+            entry.isSymLink = S_ISLNK(info.st_mode);
+        }
+
+        if (entry.isSymLink)
+            entry.exists = ::fstatat(fd_, name, &info, 0) == 0;
+
+        entry.isFile = entry.exists && S_ISREG(info.st_mode);
+        entry.isDir = entry.exists && S_ISDIR(info.st_mode);
+    }
+#else
+    QDirIterator it_;
+#endif
+};
+
+// QDirIterator's filtering, applied to ListedEntry: which entries it would
+// return (matches) and which directories it would recurse into (descends).
+// The exts globs match the whole name, case-insensitively unless
+// QDir::CaseSensitive is set ("*.ext" patterns skip the regex)
+class EntryFilter
+{
+public:
+    EntryFilter(
+        const QStringList& nameFilters,
+        QDir::Filters filters,
+        QDirIterator::IteratorFlags flags)
+        : filters_(filters == QDir::NoFilter ? QDir::AllEntries : filters)
+        , flags_(flags)
+        , cs_(
+              filters_ & QDir::CaseSensitive ? Qt::CaseSensitive
+                                             : Qt::CaseInsensitive)
+        , hasNameFilters_(!nameFilters.isEmpty())
+    {
+        for (auto& pattern : nameFilters) {
+            auto star = pattern.startsWith(u'*');
+            auto suffix = QStringView(pattern).sliced(star ? 1 : 0);
+
+            if (star && !suffix.contains(u'*') && !suffix.contains(u'?') &&
+                !suffix.contains(u'[')) {
+                suffixes_ << suffix.toString();
+            } else {
+                auto options = cs_ == Qt::CaseSensitive
+                                   ? QRegularExpression::NoPatternOption
+                                   : QRegularExpression::CaseInsensitiveOption;
+                globs_ << QRegularExpression(
+                    QRegularExpression::wildcardToRegularExpression(pattern),
+                    options);
+            }
+        }
+    }
+
+    QDir::Filters filters() const noexcept { return filters_; }
+    QDirIterator::IteratorFlags flags() const noexcept { return flags_; }
+
+    // The exts globs alone (anything passes without them)
+    bool matchesName(const QString& name) const
+    {
+        return !hasNameFilters_ || matchesName_(name);
+    }
+
+    bool matches(const DirReader& reader, const ListedEntry& entry) const
+    {
+        if (hasNameFilters_ && !((filters_ & QDir::AllDirs) && entry.isDir) &&
+            !matchesName_(entry.name))
+            return false;
+
+        auto include_system = bool(filters_ & QDir::System);
+
+        if ((filters_ & QDir::NoSymLinks) && entry.isSymLink &&
+            (!include_system || entry.exists))
+            return false;
+
+        if (!(filters_ & QDir::Hidden) && entry.isHidden)
+            return false;
+
+        if (!include_system &&
+            (!(entry.isFile || entry.isDir || entry.isSymLink) ||
+             (entry.isSymLink && !entry.exists)))
+            return false;
+
+        if (!(filters_ & (QDir::Dirs | QDir::AllDirs)) && entry.isDir)
+            return false;
+
+        if (!(filters_ & QDir::Files) && entry.isFile)
+            return false;
+
+        auto permissions = int(filters_ & QDir::PermissionMask);
+        if (permissions && permissions != QDir::PermissionMask)
+            return reader.permits(entry, filters_);
+
+        return true;
+    }
+
+    // Loop checks (for FollowSymlinks) are left to the walker
+    bool descends(const ListedEntry& entry) const noexcept
+    {
+        if (!(flags_ & QDirIterator::Subdirectories) || !entry.isDir)
+            return false;
+        if (!(flags_ & QDirIterator::FollowSymlinks) && entry.isSymLink)
+            return false;
+        if (!(filters_ & (QDir::AllDirs | QDir::Hidden)) && entry.isHidden)
+            return false;
+
+        return true;
+    }
+
+private:
+    QDir::Filters filters_;
+    QDirIterator::IteratorFlags flags_;
+    Qt::CaseSensitivity cs_;
+    bool hasNameFilters_;
+    QStringList suffixes_{};
+    QList<QRegularExpression> globs_{};
+
+    bool matchesName_(const QString& name) const
+    {
+        for (auto& suffix : suffixes_)
+            if (name.endsWith(suffix, cs_))
+                return true;
+
+        for (auto& glob : globs_)
+            if (glob.match(name).hasMatch())
+                return true;
+
+        return false;
+    }
+};
+
+} // namespace Coco::Internal
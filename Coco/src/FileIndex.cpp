@@ -0,0 +1,597 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/FileIndex.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <utility>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QtLogging>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+#include "Coco/Scan.h"
+#include "Coco/Walk.h"
+
+#include "DirReader.h"
+
+#ifdef Q_OS_LINUX
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+namespace Coco {
+
+namespace {
+
+// Every entry (names filtered separately), so the directories are all known
+QDir::Filters listFilters_(const FileIndexOptions& options)
+{
+    auto filters = QDir::AllEntries | QDir::NoDotAndDotDot;
+    if (options.hidden)
+        filters |= QDir::Hidden;
+
+    return filters;
+}
+
+QString join_(const QString& dir, const QString& name)
+{
+    return dir.endsWith(u'/') ? dir + name : dir + u'/' + name;
+}
+
+} // namespace
+
+FileIndex::FileIndex(
+    const PathList& roots,
+    const FileIndexOptions& options,
+    QObject* parent)
+    : QObject(parent)
+    , options_(options)
+    , filter_(std::make_unique<Internal::EntryFilter>(
+          options.exts,
+          QDir::Files | (options.hidden ? QDir::Hidden : QDir::Filter(0)),
+          QDirIterator::Subdirectories))
+{
+    // One spelling per directory, so child paths can be built by joining
+    for (auto& root : roots)
+        roots_ << Path(QDir::cleanPath(root.toQString()));
+
+#ifdef Q_OS_LINUX
+
+    inotify_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotify_ < 0) {
+        qWarning("Coco::FileIndex: inotify unavailable, changes won't show");
+    } else {
+        notifier_ = new QSocketNotifier(inotify_, QSocketNotifier::Read, this);
+        connect(notifier_, &QSocketNotifier::activated, this, [this] {
+            readInotify_();
+        });
+    }
+
+#else
+
+    watcher_ = new QFileSystemWatcher(this);
+    connect(
+        watcher_,
+        &QFileSystemWatcher::directoryChanged,
+        this,
+        [this](const QString& dir) {
+            syncDir_(dir);
+            flush_();
+        });
+
+#endif
+
+    build_();
+    added_.clear();
+}
+
+FileIndex::~FileIndex()
+{
+#ifdef Q_OS_LINUX
+    if (inotify_ >= 0)
+        ::close(inotify_);
+#endif
+}
+
+qsizetype FileIndex::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return qsizetype(files_.paths.size());
+}
+
+bool FileIndex::contains(const Path& path) const
+{
+    auto text = QDir::cleanPath(path.toQString());
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return files_.paths.count(text) > 0;
+}
+
+PathList FileIndex::files() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    PathList result{};
+    result.reserve(qsizetype(files_.paths.size()));
+
+    for (auto& file : files_.paths)
+        result << Path(file);
+
+    return result;
+}
+
+PathList FileIndex::withExtension(QStringView ext) const
+{
+    auto key = ext.startsWith(u'.') ? ext.toString() : u'.' + ext.toString();
+    key = key.toLower();
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = files_.byExt.find(key);
+    if (it == files_.byExt.end())
+        return {};
+
+    PathList result{};
+    result.reserve(it->size());
+
+    for (auto& file : *it)
+        result << Path(file);
+
+    return result;
+}
+
+PathList FileIndex::withPrefix(QStringView prefix) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    PathList result{};
+
+    for (auto it = files_.paths.lower_bound(prefix.toString());
+         it != files_.paths.end() && it->startsWith(prefix);
+         ++it)
+        result << Path(*it);
+
+    return result;
+}
+
+PathList FileIndex::subtree(const Path& dir) const
+{
+    auto text = QDir::cleanPath(dir.toQString());
+    return withPrefix(text.endsWith(u'/') ? text : text + u'/');
+}
+
+// Built aside and swapped in whole, so queries meanwhile still see the old
+// index rather than a partial one
+void FileIndex::resync()
+{
+    Files_ fresh{};
+
+    clear_();
+    staging_ = &fresh;
+    build_();
+    staging_ = nullptr;
+
+    // Only this thread writes files_, so reading it unlocked is safe
+    for (auto& file : fresh.paths)
+        if (!files_.paths.count(file))
+            added_ << Path(file);
+
+    for (auto& file : files_.paths)
+        if (!fresh.paths.count(file))
+            removed_ << Path(file);
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::swap(files_, fresh);
+    }
+
+    flush_();
+}
+
+void FileIndex::build_()
+{
+    PathList dirs{};
+
+    for (auto& root : roots_) {
+        if (!root.isDir())
+            continue;
+
+        dirs << root;
+        addDir_(root.toQString());
+    }
+
+    ScanOptions options{ .filters = listFilters_(options_),
+                         .flags = QDirIterator::Subdirectories,
+                         .threads = options_.threads };
+
+    // Watches added by the workers, each before its directory is listed, so
+    // nothing made during the scan is missed
+    std::mutex entered_mutex{};
+    QHash<QString, int> entered{};
+
+#ifdef Q_OS_LINUX
+    options.prune = [&](const Path& dir) {
+        auto watch = addWatch_(dir.toQString());
+        std::lock_guard<std::mutex> lock(entered_mutex);
+        entered.insert(dir.toQString(), watch);
+        return false;
+    };
+#endif
+
+    auto entries = scanEntries(dirs, options);
+
+    // Found in no particular order, so directories go in first (parents
+    // before children doesn't matter; addDir_ fills in either way)
+    for (auto& entry : entries) {
+        if (entry.isDir() && !entry.isSymLink()) {
+            auto dir = entry.path().toQString();
+            addDir_(dir, entered.value(dir, -1));
+        }
+    }
+
+    for (auto& entry : entries)
+        if (entry.isFile() &&
+            filter_->matchesName(entry.path().nameView().toString()))
+            addFile_(entry.path().toQString());
+
+#ifndef Q_OS_LINUX
+
+    // A QFileSystemWatcher can't be fed from the workers, so directories are
+    // only watched now. Each is listed again for whatever changed meanwhile
+    for (auto& dir : dirs_.keys())
+        syncDir_(dir);
+
+#endif
+}
+
+// Every watch and directory (the files stay, for resync to diff against)
+void FileIndex::clear_()
+{
+#ifdef Q_OS_LINUX
+    for (auto it = watches_.begin(); it != watches_.end(); ++it)
+        ::inotify_rm_watch(inotify_, it.key());
+
+    watches_.clear();
+#else
+    if (auto watched = watcher_->directories(); !watched.isEmpty())
+        watcher_->removePaths(watched);
+#endif
+
+    dirs_.clear();
+}
+
+void FileIndex::addDir_(const QString& dir, int watch)
+{
+    Path path(dir);
+    auto is_root = roots_.contains(path);
+
+    // First, since inserting here may move what's in dirs_
+    if (!is_root)
+        dirs_[path.parentView().toString()].subdirs.insert(
+            path.nameView().toString());
+
+    auto& node = dirs_[dir];
+    if (node.watch < 0)
+        watch_(dir, node, watch);
+}
+
+void FileIndex::addTree_(const QString& dir)
+{
+    addDir_(dir);
+
+    // Each directory is watched (as it's yielded) before the walk lists it,
+    // so nothing made meanwhile is missed
+    for (auto& entry : walkEntries(
+             Path(dir),
+             { .filters = listFilters_(options_),
+               .flags = QDirIterator::Subdirectories })) {
+        if (entry.isDir() && !entry.isSymLink())
+            addDir_(entry.path().toQString());
+        else if (
+            entry.isFile() &&
+            filter_->matchesName(entry.path().nameView().toString()))
+            addFile_(entry.path().toQString());
+    }
+}
+
+void FileIndex::removeDir_(const QString& dir)
+{
+    auto it = dirs_.find(dir);
+    if (it == dirs_.end())
+        return;
+
+    auto node = *it;
+    dirs_.erase(it);
+    unwatch_(node, dir);
+
+    Path path(dir);
+    if (auto parent = dirs_.find(path.parentView().toString());
+        parent != dirs_.end())
+        parent->subdirs.remove(path.nameView().toString());
+
+    for (auto& name : node.files)
+        removeFile_(join_(dir, name));
+
+    for (auto& name : node.subdirs)
+        removeDir_(join_(dir, name));
+}
+
+void FileIndex::addFile_(const QString& path)
+{
+    Path file(path);
+    auto& parent = dirs_[file.parentView().toString()];
+    parent.files.insert(file.nameView().toString());
+
+    if (staging_) {
+        staging_->insert(path);
+        return;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (!files_.insert(path))
+            return;
+    }
+
+    added_ << file;
+}
+
+void FileIndex::removeFile_(const QString& path)
+{
+    Path file(path);
+    if (auto parent = dirs_.find(file.parentView().toString());
+        parent != dirs_.end())
+        parent->files.remove(file.nameView().toString());
+
+    if (staging_) {
+        staging_->erase(path);
+        return;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (!files_.erase(path))
+            return;
+    }
+
+    removed_ << file;
+}
+
+// Lists dir alone and applies the difference: gone files and directories are
+// dropped (directories whole), new directories walked
+void FileIndex::syncDir_(const QString& dir)
+{
+    auto it = dirs_.find(dir);
+    if (it == dirs_.end())
+        return;
+
+    if (!QFileInfo(dir).isDir()) {
+        removeDir_(dir);
+        return;
+    }
+
+    auto old = *it;
+    QSet<QString> files{};
+    QSet<QString> subdirs{};
+    Internal::DirReader reader(dir);
+    Internal::ListedEntry entry{};
+
+    while (reader.next(entry)) {
+        if (filter_->descends(entry)) {
+            subdirs.insert(entry.name);
+        } else if (
+            entry.isFile && (options_.hidden || !entry.isHidden) &&
+            filter_->matchesName(entry.name)) {
+            files.insert(entry.name);
+        }
+    }
+
+    for (auto& name : old.files)
+        if (!files.contains(name))
+            removeFile_(join_(dir, name));
+
+    for (auto& name : old.subdirs)
+        if (!subdirs.contains(name))
+            removeDir_(join_(dir, name));
+
+    for (auto& name : files)
+        if (!old.files.contains(name))
+            addFile_(join_(dir, name));
+
+    for (auto& name : subdirs)
+        if (!old.subdirs.contains(name))
+            addTree_(join_(dir, name));
+}
+
+// Removals first, so a rename reads as the old path going, then the new one
+// coming
+void FileIndex::flush_()
+{
+    if (!removed_.isEmpty())
+        emit filesRemoved(std::exchange(removed_, {}));
+    if (!added_.isEmpty())
+        emit filesAdded(std::exchange(added_, {}));
+}
+
+// Adopts watch if the scan already added it (-1 to add one here)
+void FileIndex::watch_(const QString& dir, Dir_& node, int watch)
+{
+#ifdef Q_OS_LINUX
+
+    if (inotify_ < 0)
+        return;
+
+    if (watch < 0)
+        watch = addWatch_(dir);
+
+    if (watch < 0) {
+        qWarning(
+            "Coco::FileIndex: can't watch \"%s\" (raise "
+            "fs.inotify.max_user_watches?)",
+            qUtf8Printable(dir));
+        return;
+    }
+
+    node.watch = watch;
+    watches_[watch].insert(dir);
+
+#else
+
+    Q_UNUSED(watch);
+
+    if (watcher_->addPath(dir))
+        node.watch = 0;
+
+#endif
+}
+
+void FileIndex::unwatch_(Dir_& node, const QString& dir)
+{
+    if (node.watch < 0)
+        return;
+
+#ifdef Q_OS_LINUX
+    // The kernel's watch goes only once no path is using it
+    if (auto dirs = watches_.find(node.watch); dirs != watches_.end()) {
+        dirs->remove(dir);
+
+        if (dirs->isEmpty()) {
+            ::inotify_rm_watch(inotify_, node.watch);
+            watches_.erase(dirs);
+        }
+    }
+#else
+    watcher_->removePath(dir);
+#endif
+
+    node.watch = -1;
+}
+
+#ifdef Q_OS_LINUX
+
+// Safe from the scan's workers (touches nothing but the inotify descriptor)
+int FileIndex::addWatch_(const QString& dir) const
+{
+    if (inotify_ < 0)
+        return -1;
+
+    constexpr auto mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                          IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR |
+                          IN_DONT_FOLLOW;
+
+    return ::inotify_add_watch(
+        inotify_,
+        QFile::encodeName(dir).constData(),
+        mask);
+}
+
+// Events only say which directories changed; each is then synced once, however
+// many events it had
+void FileIndex::readInotify_()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+    QStringList changed{};
+    QSet<QString> seen{};
+    auto overflowed = false;
+
+    while (true) {
+        auto length = ::read(inotify_, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (decltype(length) pos = 0; pos < length;) {
+            auto event = reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+
+            auto dirs = watches_.find(event->wd);
+            if (dirs == watches_.end())
+                continue;
+
+            // The kernel dropped the watch (its directory is gone)
+            if (event->mask & IN_IGNORED) {
+                for (auto& dir : *dirs)
+                    if (auto node = dirs_.find(dir); node != dirs_.end())
+                        node->watch = -1;
+
+                watches_.erase(dirs);
+                continue;
+            }
+
+            for (auto& dir : *dirs) {
+                if (!seen.contains(dir)) {
+                    seen.insert(dir);
+                    changed << dir;
+                }
+            }
+        }
+    }
+
+    if (overflowed) {
+        resync();
+        return;
+    }
+
+    for (auto& dir : changed)
+        syncDir_(dir);
+
+    flush_();
+}
+
+#endif
+
+bool FileIndex::Files_::insert(const QString& path)
+{
+    if (!paths.insert(path).second)
+        return false;
+
+    byExt[extKey_(path)].insert(path);
+    return true;
+}
+
+bool FileIndex::Files_::erase(const QString& path)
+{
+    if (!paths.erase(path))
+        return false;
+
+    auto bucket = byExt.find(extKey_(path));
+
+    if (bucket != byExt.end()) {
+        bucket->remove(path);
+        if (bucket->isEmpty())
+            byExt.erase(bucket);
+    }
+
+    return true;
+}
+
+QString FileIndex::extKey_(const QString& path)
+{
+    return Path(path).extView().toString().toLower();
+}
+
+} // namespace Coco
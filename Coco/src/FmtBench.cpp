@@ -0,0 +1,459 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+// Coco::Fmt benchmark.
+//
+// Times Fmt::format (and formatTo into reused buffers) against the usual
+// alternatives: QString::arg chains, QStringBuilder, and std::format plus a
+// conversion to QString (where the standard library has it). Reports ns and
+// heap allocations per call, as a table, or JSON/CSV:
+//   CocoFmtBench --format json --output fmt.json
+//   CocoFmtBench --iterations 100000
+//
+// Qt allocates string data with malloc/realloc, not operator new, so counting
+// new alone would miss every QString. With glibc, malloc itself is counted
+// (new goes through it). Elsewhere only operator new is, and the report says
+// so ("alloc_hook")
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#if __has_include(<format>)
+#    include <format>
+#endif
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringBuilder>
+#include <QTextStream>
+#include <QtTypes>
+
+#include <Coco/Fmt.h>
+
+#if defined(__cpp_lib_format)
+#    define COCO_BENCH_STD_FORMAT 1
+#else
+#    define COCO_BENCH_STD_FORMAT 0
+#endif
+
+using namespace Qt::StringLiterals;
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<quint64> allocations{ 0 };
+
+static void countAllocation()
+{
+    allocations.fetch_add(1, std::memory_order::relaxed);
+}
+
+#if defined(__GLIBC__)
+
+static constexpr auto ALLOC_HOOK = "malloc";
+
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+
+void* malloc(std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+} // extern "C"
+
+#else
+
+static constexpr auto ALLOC_HOOK = "operator new";
+
+void* operator new(std::size_t size)
+{
+    countAllocation();
+
+    if (auto ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+#endif
+
+struct Result
+{
+    QString name{};
+    QString method{};
+    qint64 iterations = 0;
+    double nsPerCall = 0.0;
+    double allocsPerCall = 0.0;
+};
+
+// Kept live so the compiler can't drop the work being timed
+static std::atomic<qsizetype> sink{ 0 };
+
+template <typename FnT>
+static Result
+measure(const QString& name, const QString& method, qint64 iterations, FnT fn)
+{
+    // Warm up (and let reused buffers grow to size)
+    for (qint64 i = 0; i < qMin(iterations / 10, qint64(1000)); ++i)
+        sink.fetch_add(fn(i), std::memory_order::relaxed);
+
+    auto allocs_before = allocations.load(std::memory_order::relaxed);
+    auto begin = Clock::now();
+    qsizetype total = 0;
+
+    for (qint64 i = 0; i < iterations; ++i)
+        total += fn(i);
+
+    auto end = Clock::now();
+    auto allocs = allocations.load(std::memory_order::relaxed) - allocs_before;
+    sink.fetch_add(total, std::memory_order::relaxed);
+
+    Result result{};
+    result.name = name;
+    result.method = method;
+    result.iterations = iterations;
+    result.nsPerCall =
+        std::chrono::duration<double, std::nano>(end - begin).count() /
+        iterations;
+    result.allocsPerCall = double(allocs) / iterations;
+
+    return result;
+}
+
+#if COCO_BENCH_STD_FORMAT
+
+static QString fromStd(const std::string& utf8)
+{
+    return QString::fromUtf8(utf8.data(), qsizetype(utf8.size()));
+}
+
+#endif
+
+static QList<Result> runAll(qint64 n)
+{
+    QList<Result> results{};
+    QString reused{};
+    Coco::Fmt::SmallString<> small{};
+
+    auto name = u"render"_s;
+    auto path = u"/home/user/projects/coco/src/Fmt.cpp"_s;
+    auto func = "measure";
+    auto ms = 12.375;
+
+    // --- No arguments ---
+    results << measure(u"0 args"_s, u"Fmt::format"_s, n, [](qint64) {
+        return Coco::Fmt::format(u"Nothing to substitute here").size();
+    });
+    results << measure(u"0 args"_s, u"QString"_s, n, [](qint64) {
+        return QString(u"Nothing to substitute here"_s).size();
+    });
+#if COCO_BENCH_STD_FORMAT
+    results << measure(u"0 args"_s, u"std::format"_s, n, [](qint64) {
+        return fromStd(std::format("Nothing to substitute here")).size();
+    });
+#endif
+
+    // --- One integer ---
+    results << measure(u"1 int"_s, u"Fmt::format"_s, n, [](qint64 i) {
+        return Coco::Fmt::format(u"count: {}", i).size();
+    });
+    results << measure(u"1 int"_s, u"Fmt::formatTo"_s, n, [&](qint64 i) {
+        reused.resize(0);
+        Coco::Fmt::formatTo(reused, u"count: {}", i);
+        return reused.size();
+    });
+    results << measure(u"1 int"_s, u"QString::arg"_s, n, [](qint64 i) {
+        return u"count: %1"_s.arg(i).size();
+    });
+    results << measure(u"1 int"_s, u"QStringBuilder"_s, n, [](qint64 i) {
+        QString out = u"count: "_s % QString::number(i);
+        return out.size();
+    });
+#if COCO_BENCH_STD_FORMAT
+    results << measure(u"1 int"_s, u"std::format"_s, n, [](qint64 i) {
+        return fromStd(std::format("count: {}", i)).size();
+    });
+#endif
+
+    // --- Two, mixed ---
+    results << measure(u"2 mixed"_s, u"Fmt::format"_s, n, [&](qint64) {
+        return Coco::Fmt::format(u"{} took {} ms", name, ms).size();
+    });
+    results << measure(u"2 mixed"_s, u"QString::arg"_s, n, [&](qint64) {
+        return u"%1 took %2 ms"_s.arg(name).arg(ms).size();
+    });
+    results << measure(u"2 mixed"_s, u"QStringBuilder"_s, n, [&](qint64) {
+        QString out = name % u" took "_s % QString::number(ms) % u" ms"_s;
+        return out.size();
+    });
+#if COCO_BENCH_STD_FORMAT
+    results << measure(u"2 mixed"_s, u"std::format"_s, n, [&](qint64) {
+        return fromStd(std::format("{} took {} ms", name.toStdString(), ms))
+            .size();
+    });
+#endif
+
+    // --- Four, mixed (a typical log line) ---
+    results << measure(u"4 mixed"_s, u"Fmt::format"_s, n, [&](qint64 i) {
+        return Coco::Fmt::format(u"{}:{} in {} ({} ms)", path, i, func, ms)
+            .size();
+    });
+    results << measure(u"4 mixed"_s, u"Fmt::formatTo"_s, n, [&](qint64 i) {
+        small.clear();
+        Coco::Fmt::formatTo(small, u"{}:{} in {} ({} ms)", path, i, func, ms);
+        return small.size();
+    });
+    results << measure(u"4 mixed"_s, u"QString::arg"_s, n, [&](qint64 i) {
+        return u"%1:%2 in %3 (%4 ms)"_s.arg(path)
+            .arg(i)
+            .arg(QString::fromUtf8(func))
+            .arg(ms)
+            .size();
+    });
+    results << measure(u"4 mixed"_s, u"QStringBuilder"_s, n, [&](qint64 i) {
+        QString out = path % u':' % QString::number(i) % u" in "_s %
+                      QString::fromUtf8(func) % u" ("_s % QString::number(ms) %
+                      u" ms)"_s;
+        return out.size();
+    });
+#if COCO_BENCH_STD_FORMAT
+    results << measure(u"4 mixed"_s, u"std::format"_s, n, [&](qint64 i) {
+        return fromStd(std::format(
+                           "{}:{} in {} ({} ms)",
+                           path.toStdString(),
+                           i,
+                           func,
+                           ms))
+            .size();
+    });
+#endif
+
+    // --- Eight integers ---
+    results << measure(u"8 ints"_s, u"Fmt::format"_s, n, [](qint64 i) {
+        return Coco::Fmt::format(
+                   u"{} {} {} {} {} {} {} {}",
+                   i,
+                   i + 1,
+                   i + 2,
+                   i + 3,
+                   i + 4,
+                   i + 5,
+                   i + 6,
+                   i + 7)
+            .size();
+    });
+    results << measure(u"8 ints"_s, u"QString::arg"_s, n, [](qint64 i) {
+        return u"%1 %2 %3 %4 %5 %6 %7 %8"_s.arg(i)
+            .arg(i + 1)
+            .arg(i + 2)
+            .arg(i + 3)
+            .arg(i + 4)
+            .arg(i + 5)
+            .arg(i + 6)
+            .arg(i + 7)
+            .size();
+    });
+#if COCO_BENCH_STD_FORMAT
+    results << measure(u"8 ints"_s, u"std::format"_s, n, [](qint64 i) {
+        return fromStd(std::format(
+                           "{} {} {} {} {} {} {} {}",
+                           i,
+                           i + 1,
+                           i + 2,
+                           i + 3,
+                           i + 4,
+                           i + 5,
+                           i + 6,
+                           i + 7))
+            .size();
+    });
+#endif
+
+    // --- Long literal runs ---
+    results << measure(u"long literal"_s, u"Fmt::format"_s, n, [&](qint64 i) {
+        return Coco::Fmt::format(
+                   u"Finished indexing the workspace after scanning every "
+                   u"directory under the project root, skipping ignored paths "
+                   u"and following no symlinks: {} files in {} ms, with the "
+                   u"cache written back to disk for the next session",
+                   i,
+                   ms)
+            .size();
+    });
+    results << measure(u"long literal"_s, u"QString::arg"_s, n, [&](qint64 i) {
+        return u"Finished indexing the workspace after scanning every "
+               u"directory under the project root, skipping ignored paths "
+               u"and following no symlinks: %1 files in %2 ms, with the "
+               u"cache written back to disk for the next session"_s.arg(i)
+            .arg(ms)
+            .size();
+    });
+
+    // --- Specs (width, precision, hex) ---
+    results << measure(u"specs"_s, u"Fmt::format"_s, n, [&](qint64 i) {
+        return Coco::Fmt::format(u"{:08x} {:.3f} {:>12}", i, ms, name).size();
+    });
+    results << measure(u"specs"_s, u"QString::arg"_s, n, [&](qint64 i) {
+        return u"%1 %2 %3"_s.arg(i, 8, 16, u'0')
+            .arg(ms, 0, 'f', 3)
+            .arg(name, 12)
+            .size();
+    });
+#if COCO_BENCH_STD_FORMAT
+    results << measure(u"specs"_s, u"std::format"_s, n, [&](qint64 i) {
+        return fromStd(std::format(
+                           "{:08x} {:.3f} {:>12}",
+                           i,
+                           ms,
+                           name.toStdString()))
+            .size();
+    });
+#endif
+
+    return results;
+}
+
+static void writeTable(QTextStream& out, const QList<Result>& results)
+{
+    out << "Allocations counted at: " << ALLOC_HOOK << Qt::endl << Qt::endl;
+    out << Qt::left << qSetFieldWidth(16) << "case" << "method"
+        << qSetFieldWidth(12) << "ns/call" << "allocs/call" << qSetFieldWidth(0)
+        << Qt::endl;
+
+    for (auto& r : results) {
+        out << qSetFieldWidth(16) << r.name << r.method << qSetFieldWidth(12)
+            << QString::number(r.nsPerCall, 'f', 1)
+            << QString::number(r.allocsPerCall, 'f', 2) << qSetFieldWidth(0)
+            << Qt::endl;
+    }
+}
+
+static void writeCsv(QTextStream& out, const QList<Result>& results)
+{
+    out << "case,method,iterations,ns_per_call,allocs_per_call\n";
+
+    for (auto& r : results) {
+        out << r.name << ',' << r.method << ',' << r.iterations << ','
+            << QString::number(r.nsPerCall, 'f', 2) << ','
+            << QString::number(r.allocsPerCall, 'f', 3) << '\n';
+    }
+}
+
+static void writeJson(QTextStream& out, const QList<Result>& results)
+{
+    QJsonArray array{};
+
+    for (auto& r : results) {
+        array.append(QJsonObject{
+            { u"case"_s, r.name },
+            { u"method"_s, r.method },
+            { u"iterations"_s, r.iterations },
+            { u"ns_per_call"_s, r.nsPerCall },
+            { u"allocs_per_call"_s, r.allocsPerCall },
+        });
+    }
+
+    QJsonObject root{
+        { u"coco_version"_s, QString::fromUtf8(COCO_BENCH_VERSION) },
+        { u"qt_version"_s, QString::fromUtf8(qVersion()) },
+        { u"alloc_hook"_s, QString::fromUtf8(ALLOC_HOOK) },
+        { u"std_format"_s, bool(COCO_BENCH_STD_FORMAT) },
+        { u"results"_s, array },
+    };
+
+    out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser{};
+    parser.setApplicationDescription(u"Coco::Fmt benchmark"_s);
+    parser.addHelpOption();
+
+    QCommandLineOption format_option(
+        u"format"_s,
+        u"Output format: table, json or csv"_s,
+        u"format"_s,
+        u"table"_s);
+    QCommandLineOption output_option(
+        u"output"_s,
+        u"Write results to this file instead of stdout"_s,
+        u"file"_s);
+    QCommandLineOption iterations_option(
+        u"iterations"_s,
+        u"Calls per case"_s,
+        u"n"_s,
+        u"200000"_s);
+
+    parser.addOptions({ format_option, output_option, iterations_option });
+    parser.process(app);
+
+    auto format = parser.value(format_option);
+    auto iterations =
+        qMax(parser.value(iterations_option).toLongLong(), qint64(1));
+
+    auto results = runAll(iterations);
+
+    QFile file{};
+    QTextStream out(stdout);
+
+    if (parser.isSet(output_option)) {
+        file.setFileName(parser.value(output_option));
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream(stderr)
+                << "Can't write " << file.fileName() << Qt::endl;
+            return 1;
+        }
+
+        out.setDevice(&file);
+    }
+
+    if (format == u"json")
+        writeJson(out, results);
+    else if (format == u"csv")
+        writeCsv(out, results);
+    else
+        writeTable(out, results);
+
+    out.flush();
+    return 0;
+}
@@ -0,0 +1,617 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+// Coco::Fmt differential test.
+//
+// Random templates (literal text, {}, escapes, stray braces, valid and broken
+// {:spec} fields) and random arguments, formatted by Fmt's runtime walker, its
+// other outputs (SmallString, exact sizing) and Record::render, then compared
+// with a deliberately plain reference built on snprintf. Then a fixed set of
+// literals, to hold the compile-time parser to the runtime one. Deterministic
+// for a given seed:
+//   CocoFmtFuzz --seed 7 --iterations 100000
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <regex>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringView>
+#include <QTextStream>
+#include <QtLogging>
+#include <QtTypes>
+
+#include <Coco/Fmt.h>
+#include <Coco/LogRecord.h>
+
+using namespace Qt::StringLiterals;
+
+using Arg = std::variant<qint64, quint64, float, double, std::string>;
+
+static int failures = 0;
+constexpr auto MAX_REPORTED = 20;
+
+// --- Reference --------------------------------------------------------------
+
+struct RefSpec
+{
+    char fill = ' ';
+    char align = 0;
+    char sign = 0;
+    bool alternate = false;
+    bool zero = false;
+    int width = 0;
+    int precision = -1;
+    char type = 0;
+};
+
+// Pads body to the spec's width
+static std::string
+aligned(const RefSpec& spec, const std::string& body, char defaultAlign)
+{
+    auto padding = spec.width > int(body.size()) ? spec.width - body.size() : 0;
+    auto align = spec.align ? spec.align : defaultAlign;
+    auto before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+
+    return std::string(before, spec.fill) + body +
+           std::string(padding - before, spec.fill);
+}
+
+static std::string
+number(const RefSpec& spec, const std::string& prefix, const std::string& body)
+{
+    if (spec.zero && !spec.align) {
+        auto length = int(prefix.size() + body.size());
+        auto zeros = spec.width > length ? spec.width - length : 0;
+        return prefix + std::string(zeros, '0') + body;
+    }
+
+    return aligned(spec, prefix + body, '>');
+}
+
+template <typename T> static std::string shortest(T value)
+{
+    char buffer[64];
+    auto last = std::to_chars(buffer, buffer + sizeof buffer, value).ptr;
+    return std::string(buffer, last);
+}
+
+static std::string floating(const RefSpec& spec, double value, bool isFloat)
+{
+    std::string text{};
+    std::string conversion = "";
+
+    switch (spec.type) {
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+        conversion = spec.type;
+        break;
+    default:
+        break;
+    }
+
+    if (conversion.empty() && spec.precision < 0) {
+        text = isFloat ? shortest(float(value)) : shortest(value);
+    } else {
+        if (conversion.empty())
+            conversion = "g";
+
+        auto precision = spec.precision < 0 ? 6 : spec.precision;
+        auto format = "%." + std::to_string(precision) + conversion;
+        std::vector<char> buffer(precision + 400);
+        auto size =
+            std::snprintf(buffer.data(), buffer.size(), format.c_str(), value);
+        text.assign(buffer.data(), size);
+    }
+
+    std::string sign{};
+
+    if (!text.empty() && text[0] == '-') {
+        sign = "-";
+        text.erase(0, 1);
+    } else if (spec.sign) {
+        sign = spec.sign;
+    }
+
+    auto finite_spec = spec;
+    finite_spec.zero = spec.zero && std::isfinite(value);
+    return number(finite_spec, sign, text);
+}
+
+static std::string
+integer(const RefSpec& spec, quint64 magnitude, bool negative)
+{
+    switch (spec.type) {
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G': {
+        auto value = double(magnitude);
+        return floating(spec, negative ? -value : value, false);
+    }
+    default:
+        break;
+    }
+
+    char buffer[80];
+    auto wide = static_cast<unsigned long long>(magnitude);
+    std::string digits{};
+    std::string base_prefix{};
+
+    switch (spec.type) {
+    case 'b':
+    case 'B':
+        do {
+            digits.insert(digits.begin(), char('0' + (magnitude & 1)));
+            magnitude >>= 1;
+        } while (magnitude);
+        base_prefix = spec.type == 'b' ? "0b" : "0B";
+        break;
+    case 'o':
+        std::snprintf(buffer, sizeof buffer, "%llo", wide);
+        digits = buffer;
+        base_prefix = magnitude ? "0" : "";
+        break;
+    case 'x':
+    case 'X':
+        std::snprintf(
+            buffer,
+            sizeof buffer,
+            spec.type == 'x' ? "%llx" : "%llX",
+            wide);
+        digits = buffer;
+        base_prefix = spec.type == 'x' ? "0x" : "0X";
+        break;
+    default:
+        std::snprintf(buffer, sizeof buffer, "%llu", wide);
+        digits = buffer;
+        break;
+    }
+
+    std::string prefix{};
+
+    if (negative)
+        prefix = "-";
+    else if (spec.sign)
+        prefix = spec.sign;
+
+    if (spec.alternate)
+        prefix += base_prefix;
+
+    return number(spec, prefix, digits);
+}
+
+static std::string render(const RefSpec& spec, const Arg& arg)
+{
+    if (auto text = std::get_if<std::string>(&arg)) {
+        auto body = *text;
+        if (spec.precision >= 0 && spec.precision < int(body.size()))
+            body.resize(spec.precision);
+
+        return aligned(spec, body, '<');
+    }
+
+    if (auto value = std::get_if<qint64>(&arg)) {
+        auto negative = *value < 0;
+        auto magnitude = negative ? 0 - quint64(*value) : quint64(*value);
+        return integer(spec, magnitude, negative);
+    }
+
+    if (auto value = std::get_if<quint64>(&arg))
+        return integer(spec, *value, false);
+
+    if (auto value = std::get_if<float>(&arg))
+        return floating(spec, *value, true);
+
+    return floating(spec, std::get<double>(arg), false);
+}
+
+// Matches a spec and its closing brace, starting just past the ':'
+static const std::regex specPattern(
+    R"(^(([^{}])([<>^])|([<>^]))?([-+ ])?(#)?(0)?([0-9]*)(\.([0-9]+))?)"
+    R"(([bBdoxXeEfFgGs])?\})");
+
+static bool parseRefSpec(const std::string& tail, RefSpec& spec, size_t& used)
+{
+    std::smatch match{};
+    if (!std::regex_search(tail, match, specPattern))
+        return false;
+
+    if (match[2].matched) {
+        spec.fill = match[2].str()[0];
+        spec.align = match[3].str()[0];
+    } else if (match[4].matched) {
+        spec.align = match[4].str()[0];
+    }
+
+    if (match[5].matched && match[5].str() != "-")
+        spec.sign = match[5].str()[0];
+
+    spec.alternate = match[6].matched;
+    spec.zero = match[7].matched;
+
+    // Same caps as Fmt (0x7FFF)
+    auto capped = [](const std::string& digits, int& out) {
+        out = 0;
+        for (auto ch : digits) {
+            out = out * 10 + (ch - '0');
+            if (out > 0x7FFF)
+                return false;
+        }
+        return true;
+    };
+
+    if (!capped(match[8].str(), spec.width))
+        return false;
+    if (match[9].matched && !capped(match[10].str(), spec.precision))
+        return false;
+    if (match[11].matched)
+        spec.type = match[11].str()[0];
+
+    used = size_t(match.length(0));
+    return true;
+}
+
+static std::string
+reference(const std::string& tmpl, const std::vector<Arg>& args)
+{
+    std::string out{};
+    size_t next_arg = 0;
+    size_t i = 0;
+
+    auto substitute = [&](const RefSpec& spec) {
+        if (next_arg < args.size())
+            out += render(spec, args[next_arg++]);
+    };
+
+    while (i < tmpl.size()) {
+        auto ch = tmpl[i];
+        auto next = i + 1 < tmpl.size() ? tmpl[i + 1] : '\0';
+
+        if (ch == '{' && next == '{') {
+            out += '{';
+            i += 2;
+        } else if (ch == '}' && next == '}') {
+            out += '}';
+            i += 2;
+        } else if (ch == '{' && next == '}') {
+            substitute({});
+            i += 2;
+        } else if (ch == '{' && next == ':') {
+            RefSpec spec{};
+            size_t used = 0;
+
+            if (parseRefSpec(tmpl.substr(i + 2), spec, used)) {
+                substitute(spec);
+                i += 2 + used;
+            } else {
+                out += ch;
+                ++i;
+            }
+        } else {
+            out += ch;
+            ++i;
+        }
+    }
+
+    return out;
+}
+
+// --- Generator --------------------------------------------------------------
+
+static QRandomGenerator rng{};
+
+static int pick(int n) { return int(rng.bounded(n)); }
+
+static std::string randomSpec()
+{
+    static const char* aligns = "<>^";
+    static const char* fills = "*-_.0 :<";
+    static const char* signs = "+- ";
+    static const char* types = "bBdoxXeEfFgGs";
+
+    std::string spec = ":";
+
+    if (pick(3) == 0) {
+        if (pick(2))
+            spec += fills[pick(8)];
+        spec += aligns[pick(3)];
+    }
+
+    if (pick(4) == 0)
+        spec += signs[pick(3)];
+    if (pick(5) == 0)
+        spec += '#';
+    if (pick(4) == 0)
+        spec += '0';
+    if (pick(2))
+        spec += std::to_string(pick(20) == 0 ? 40000 : pick(16));
+    if (pick(3) == 0)
+        spec += "." + std::to_string(pick(20) == 0 ? 300 : pick(10));
+    if (pick(2))
+        spec += types[pick(13)];
+
+    // Sometimes broken
+    if (pick(12) == 0)
+        spec.insert(pick(int(spec.size())) + 1, 1, "q{.:"[pick(4)]);
+
+    return spec + (pick(15) ? "}" : "");
+}
+
+static std::string randomTemplate()
+{
+    static const char* literal = "ab xyz:-%<>^0.#";
+    std::string tmpl{};
+    auto tokens = pick(12);
+
+    for (auto t = 0; t < tokens; ++t) {
+        switch (pick(10)) {
+        case 0:
+            tmpl += "{}";
+            break;
+        case 1:
+        case 2:
+            tmpl += "{" + randomSpec();
+            break;
+        case 3:
+            tmpl += pick(2) ? "{{" : "}}";
+            break;
+        case 4:
+            tmpl += "{}"[pick(2)];
+            break;
+        default:
+            tmpl.append(pick(4) + 1, literal[pick(15)]);
+            break;
+        }
+    }
+
+    return tmpl;
+}
+
+static double randomDouble()
+{
+    static const double specials[] = {
+        0.0,
+        -0.0,
+        0.1,
+        0.5,
+        2.5,
+        1e6,
+        123456.0,
+        1e-7,
+        1e300,
+        -1e-300,
+        5e-324,
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+    };
+
+    if (pick(3) == 0)
+        return specials[pick(int(std::size(specials)))];
+
+    auto magnitude = rng.generateDouble() * std::pow(10.0, pick(40) - 20);
+    return pick(2) ? magnitude : -magnitude;
+}
+
+static Arg randomArg()
+{
+    switch (pick(5)) {
+    case 0: {
+        static const qint64 specials[] = {
+            0,
+            -1,
+            255,
+            std::numeric_limits<qint64>::min(),
+            std::numeric_limits<qint64>::max(),
+        };
+
+        if (pick(3) == 0)
+            return specials[pick(5)];
+
+        return qint64(rng.generate64()) >> pick(64);
+    }
+    case 1:
+        return quint64(rng.generate64() >> pick(64));
+    case 2:
+        return float(randomDouble());
+    case 3:
+        return randomDouble();
+    default: {
+        static const char* chars = "abc {}:xyz";
+        return std::string(pick(7), chars[pick(10)]);
+    }
+    }
+}
+
+static QString describe(const std::string& tmpl, const std::vector<Arg>& args)
+{
+    auto text = u"template \""_s + QString::fromStdString(tmpl) +
+                u"\" args ["_s;
+
+    for (auto& arg : args) {
+        if (auto s = std::get_if<std::string>(&arg))
+            text += u'"' + QString::fromStdString(*s) + u"\" "_s;
+        else if (auto i = std::get_if<qint64>(&arg))
+            text += QString::number(*i) + u"i "_s;
+        else if (auto u = std::get_if<quint64>(&arg))
+            text += QString::number(*u) + u"u "_s;
+        else if (auto f = std::get_if<float>(&arg))
+            text += QString::number(*f, 'g', 9) + u"f "_s;
+        else
+            text += QString::number(std::get<double>(arg), 'g', 17) + u' ';
+    }
+
+    return text + u']';
+}
+
+static void
+expectEqual(const QString& what, const QString& got, const QString& want)
+{
+    if (got == want)
+        return;
+
+    if (++failures <= MAX_REPORTED) {
+        QTextStream(stderr) << "FAIL: " << what << "\n  got:  \"" << got
+                            << "\"\n  want: \"" << want << "\"" << Qt::endl;
+    }
+}
+
+static void fuzzOnce()
+{
+    auto tmpl = randomTemplate();
+    std::vector<Arg> args(pick(5));
+
+    for (auto& arg : args)
+        arg = randomArg();
+
+    auto want = QString::fromStdString(reference(tmpl, args));
+    auto q_tmpl = QString::fromStdString(tmpl);
+    auto count = qsizetype(args.size());
+
+    auto values = std::make_unique<Coco::Fmt::Internal::ArgView_[]>(count);
+    Coco::Debug::Record record(QtInfoMsg, __FILE__, __LINE__, "fuzz", nullptr);
+    record.setFormat(q_tmpl);
+
+    for (qsizetype i = 0; i < count; ++i) {
+        auto& value = values[i];
+        auto& arg = args[i];
+
+        if (auto s = std::get_if<std::string>(&arg)) {
+            value.owned = QString::fromStdString(*s);
+            value.view = value.owned;
+            record.append(value.owned);
+        } else if (auto n = std::get_if<qint64>(&arg)) {
+            value.setInt(*n);
+            record.append(*n);
+        } else if (auto u = std::get_if<quint64>(&arg)) {
+            value.setUInt(*u);
+            record.append(*u);
+        } else if (auto f = std::get_if<float>(&arg)) {
+            value.setFloat(*f);
+            record.append(*f);
+        } else {
+            auto d = std::get<double>(arg);
+            value.setDouble(d);
+            record.append(d);
+        }
+    }
+
+    auto what = describe(tmpl, args);
+    auto got = Coco::Fmt::Internal::format_(q_tmpl, values.get(), count);
+    expectEqual(what, got, want);
+
+    Coco::Fmt::SmallString<16> small{};
+    Coco::Fmt::Internal::formatTo_(small, q_tmpl, values.get(), count);
+    expectEqual(what + u" (SmallString)"_s, small.toString(), want);
+
+    Coco::Fmt::Internal::Counter_ counter{};
+    Coco::Fmt::Internal::formatTo_(counter, q_tmpl, values.get(), count);
+    expectEqual(
+        what + u" (size)"_s,
+        QString::number(counter.size()),
+        QString::number(want.size()));
+
+    // No args means no walk in Record (as in Log::print)
+    if (count > 0)
+        expectEqual(what + u" (Record)"_s, record.render(), want);
+}
+
+// --- Compile-time parity ----------------------------------------------------
+
+static QString runtime(const char16_t* tmpl)
+{
+    return QString::fromUtf16(tmpl);
+}
+
+static QString runtime(const char* tmpl) { return QString::fromUtf8(tmpl); }
+
+// Same literal, parsed at compile time and walked at runtime
+#define PARITY(Tmpl, ...)                                                      \
+    expectEqual(                                                               \
+        QString::fromUtf8(#Tmpl),                                              \
+        Coco::Fmt::format(Tmpl, __VA_ARGS__),                                  \
+        Coco::Fmt::format(runtime(Tmpl), __VA_ARGS__))
+
+static void checkParity()
+{
+    auto text = u"text"_s;
+
+    PARITY(u"{}", 1);
+    PARITY(u"a {} b {} c", 1, text);
+    PARITY("a {} b {} c", 1, text);
+    PARITY(u"{{}} {} }}", 5);
+    PARITY(u"lone { and } {}", 5);
+    PARITY(u"{:q} {} {", 1);
+    PARITY(u"{:08x}|{:>6}|{:.2f}", 255, text, 1.005);
+    PARITY("{:#010b} {:+e} {:^9}", 5, 0.25, text);
+    PARITY(u"{::<6}|{:*^7.2}|{:-5}", 1, text, -3);
+    PARITY(u"{:.3}{:G}{:.0f}", 3.14159, 1e-9, 2.5);
+    PARITY(u"{{{{{{{{{{{{{{{{{{{{ {} }}}}}}}}}}}}}}}}", 1);
+    PARITY("h\xc3\xa9 {:>5} \xe2\x9c\x93", 1);
+    PARITY(u"{} {} {} {} {} {} {} {}", 1, 2u, 3.0, 4.0f, text, "six", -7, 8);
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser{};
+    parser.setApplicationDescription(u"Coco::Fmt differential test"_s);
+    parser.addHelpOption();
+
+    QCommandLineOption seed_option(
+        u"seed"_s,
+        u"Random seed (runs are repeatable per seed)"_s,
+        u"n"_s,
+        u"1"_s);
+    QCommandLineOption iterations_option(
+        u"iterations"_s,
+        u"Random templates to check"_s,
+        u"n"_s,
+        u"20000"_s);
+
+    parser.addOptions({ seed_option, iterations_option });
+    parser.process(app);
+
+    auto seed = parser.value(seed_option).toUInt();
+    auto iterations = parser.value(iterations_option).toLongLong();
+    rng.seed(seed);
+
+    for (qint64 i = 0; i < iterations; ++i)
+        fuzzOnce();
+
+    checkParity();
+
+    QTextStream(stdout) << (failures ? "FAILED" : "passed") << " (seed " << seed
+                        << ", " << iterations << " templates, " << failures
+                        << " failures)" << Qt::endl;
+
+    return failures ? 1 : 0;
+}
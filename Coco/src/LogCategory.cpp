@@ -0,0 +1,309 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/LogCategory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringView>
+#include <QtLogging>
+
+#include "Coco/Debug.h"
+#include "Coco/Path.h"
+
+namespace Coco::Debug {
+
+namespace Internal {
+
+// Matches Debug.cpp's minimumLevel_ before init (FATAL only). Constant
+// initialized, so logging during another TU's static init is still safe
+constinit Category defaultCategory_{ "default", severity(QtFatalMsg) };
+std::atomic<bool> hasObjectLevels_{ false };
+
+struct CategoryAccess_
+{
+    static void set(Category& category, int floor, int objectFloor)
+    {
+        category.floor_.store(floor, std::memory_order::relaxed);
+        category.gate_.store(
+            std::min(floor, objectFloor),
+            std::memory_order::relaxed);
+    }
+};
+
+} // namespace Internal
+
+namespace {
+
+// Above every severity, so it never lowers a gate
+constexpr auto NO_OBJECT_FLOOR_ = severity(QtFatalMsg) + 1;
+
+struct Rule_
+{
+    QString pattern{};
+    int floor = 0;
+};
+
+// Owns the name, which the category points into. List nodes never move
+struct Entry_
+{
+    explicit Entry_(const char* name, int floor)
+        : name(name)
+        , category(this->name.constData(), floor)
+    {
+    }
+
+    QByteArray name;
+    Category category;
+};
+
+// Guards everything below (registry, rules and the base floor). Only taken to
+// register or reconfigure, never to check a level
+std::mutex mutex_{};
+int baseFloor_ = severity(QtFatalMsg);
+QList<Rule_> rules_{};
+QHash<QByteArray, Category*> lookup_{};
+
+// Function-local so categories can register during static init
+std::list<Entry_>& entries_()
+{
+    static std::list<Entry_> entries{};
+    return entries;
+}
+
+std::shared_mutex objectMutex_{};
+QHash<const QObject*, int> objectLevels_{};
+std::atomic<int> objectFloor_{ NO_OBJECT_FLOOR_ };
+
+bool matches_(QStringView pattern, QStringView name)
+{
+    if (pattern == u"*")
+        return true;
+
+    auto leading = pattern.startsWith(u'*');
+    auto trailing = pattern.endsWith(u'*');
+    auto core = pattern.sliced(leading ? 1 : 0);
+    core.chop(trailing ? 1 : 0);
+
+    if (leading && trailing)
+        return name.contains(core);
+    if (leading)
+        return name.endsWith(core);
+    if (trailing)
+        return name.startsWith(core);
+
+    return name == core;
+}
+
+// Call with mutex_ held
+int floorFor_(const char* name)
+{
+    auto q_name = QString::fromUtf8(name);
+    auto floor = baseFloor_;
+
+    for (auto& rule : rules_)
+        if (matches_(rule.pattern, q_name))
+            floor = rule.floor;
+
+    return floor;
+}
+
+// Call with mutex_ held
+void apply_(Category& category)
+{
+    Internal::CategoryAccess_::set(
+        category,
+        floorFor_(category.name()),
+        objectFloor_.load(std::memory_order::relaxed));
+}
+
+// Call with mutex_ held
+void applyAll_()
+{
+    apply_(Internal::defaultCategory_);
+
+    for (auto& entry : entries_())
+        apply_(entry.category);
+}
+
+int parseLevel_(QStringView level)
+{
+    if (level == u"debug")
+        return severity(QtDebugMsg);
+    if (level == u"info")
+        return severity(QtInfoMsg);
+    if (level == u"warning")
+        return severity(QtWarningMsg);
+    if (level == u"critical")
+        return severity(QtCriticalMsg);
+    if (level == u"off")
+        return severity(QtFatalMsg);
+
+    return -1;
+}
+
+QList<Rule_> parseRules_(QStringView text)
+{
+    QList<Rule_> rules{};
+
+    for (auto line : text.tokenize(u'\n')) {
+        line = line.trimmed();
+        if (line.startsWith(u'#'))
+            continue;
+
+        for (auto rule : line.tokenize(u';')) {
+            auto eq = rule.indexOf(u'=');
+            if (eq < 1)
+                continue;
+
+            auto pattern = rule.first(eq).trimmed();
+            auto level = rule.sliced(eq + 1).trimmed().toString().toLower();
+            auto floor = parseLevel_(level);
+
+            if (pattern.isEmpty() || floor < 0) {
+                qWarning(
+                    "Coco: ignoring log rule \"%s\"",
+                    qUtf8Printable(rule.toString()));
+                continue;
+            }
+
+            rules << Rule_{ pattern.toString(), floor };
+        }
+    }
+
+    return rules;
+}
+
+// Call with objectMutex_ held (exclusively). Then re-apply the categories
+void updateObjectFloor_()
+{
+    auto floor = NO_OBJECT_FLOOR_;
+    for (auto level : std::as_const(objectLevels_))
+        floor = std::min(floor, level);
+
+    objectFloor_.store(floor, std::memory_order::relaxed);
+    Internal::hasObjectLevels_.store(
+        !objectLevels_.isEmpty(),
+        std::memory_order::relaxed);
+}
+
+} // namespace
+
+Category& category(const char* name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    QByteArray key(name);
+    if (key == Internal::defaultCategory_.name())
+        return Internal::defaultCategory_;
+    if (auto it = lookup_.constFind(key); it != lookup_.cend())
+        return **it;
+
+    auto& entry = entries_().emplace_back(name, baseFloor_);
+    apply_(entry.category);
+    lookup_.insert(key, &entry.category);
+
+    return entry.category;
+}
+
+void setLogRules(QStringView rules)
+{
+    auto parsed = parseRules_(rules);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    rules_ = std::move(parsed);
+    applyAll_();
+}
+
+bool loadLogRules(const Path& file)
+{
+    QFile rules_file(file.toQString());
+    if (!rules_file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    setLogRules(QString::fromUtf8(rules_file.readAll()));
+    return true;
+}
+
+void setObjectLevel(QObject* obj, QtMsgType level)
+{
+    if (!obj)
+        return;
+
+    auto is_new = false;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(objectMutex_);
+        is_new = !objectLevels_.contains(obj);
+        objectLevels_.insert(obj, severity(level));
+        updateObjectFloor_();
+    }
+
+    if (is_new) {
+        QObject::connect(obj, &QObject::destroyed, [obj] {
+            clearObjectLevel(obj);
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    applyAll_();
+}
+
+void clearObjectLevel(const QObject* obj)
+{
+    {
+        std::unique_lock<std::shared_mutex> lock(objectMutex_);
+        if (!objectLevels_.remove(obj))
+            return;
+
+        updateObjectFloor_();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    applyAll_();
+}
+
+namespace Internal {
+
+bool objectAllows_(const QObject* obj, int severity, const Category& category)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(objectMutex_);
+        if (auto it = objectLevels_.constFind(obj); it != objectLevels_.cend())
+            return severity >= *it;
+    }
+
+    return severity >= category.floor();
+}
+
+void setBaseFloor_(int floor)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    baseFloor_ = floor;
+    applyAll_();
+}
+
+} // namespace Internal
+
+} // namespace Coco::Debug
@@ -0,0 +1,136 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+// Private to Debug.cpp (not installed, not part of the public include tree)
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Coco::Debug::Internal {
+
+// Bounded lock-free queue (Dmitry Vyukov's sequence-per-cell design). Any
+// number of threads may push and pop. Debug only has one real consumer (the
+// writer thread), but Overflow::DropOldest evicts by having the producer pop,
+// so the pop side has to stay multi-consumer safe too
+//
+// Positions are monotonically increasing tickets, never wrapped, so they double
+// as counters: pushed() is the number of slots claimed so far and popped() the
+// number released. A claimed-but-unpublished slot blocks popping past it, which
+// is what lets Debug::flush() treat "popped() >= some earlier pushed()" as
+// "everything before that point is out of the queue"
+template <typename T> class LogQueue
+{
+public:
+    explicit LogQueue(std::size_t capacity)
+        : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+        , cells_(std::make_unique<Cell_[]>(mask_ + 1))
+    {
+        for (std::size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order::relaxed);
+    }
+
+    LogQueue(const LogQueue&) = delete;
+    LogQueue& operator=(const LogQueue&) = delete;
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    std::size_t pushed() const noexcept
+    {
+        return tail_.load(std::memory_order::acquire);
+    }
+
+    std::size_t popped() const noexcept
+    {
+        return head_.load(std::memory_order::acquire);
+    }
+
+    // Returns false (and leaves value untouched) if the queue is full
+    bool tryPush(T& value)
+    {
+        auto pos = tail_.load(std::memory_order::relaxed);
+
+        while (true) {
+            auto& cell = cells_[pos & mask_];
+            auto seq = cell.sequence.load(std::memory_order::acquire);
+            auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(
+                        pos,
+                        pos + 1,
+                        std::memory_order::relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T& out)
+    {
+        auto pos = head_.load(std::memory_order::relaxed);
+
+        while (true) {
+            auto& cell = cells_[pos & mask_];
+            auto seq = cell.sequence.load(std::memory_order::acquire);
+            auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(
+                        pos,
+                        pos + 1,
+                        std::memory_order::relaxed)) {
+                    out = std::move(cell.value);
+                    cell.sequence.store(
+                        pos + mask_ + 1,
+                        std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell_
+    {
+        std::atomic<std::size_t> sequence{ 0 };
+        T value{};
+    };
+
+    // Separate cache lines so producers (tail) and the writer (head) don't
+    // false-share
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+    std::size_t mask_;
+    std::unique_ptr<Cell_[]> cells_;
+};
+
+} // namespace Coco::Debug::Internal
@@ -0,0 +1,154 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/LogRecord.h"
+
+#include <cstring>
+#include <memory>
+
+#include <QByteArrayView>
+#include <QLatin1StringView>
+#include <QString>
+#include <QStringView>
+
+#include "Coco/Fmt.h"
+
+using namespace Qt::StringLiterals;
+
+namespace Coco::Debug {
+
+namespace {
+
+// Sequential reader over a Record payload. Mirrors the put* helpers in
+// LogRecord.h, including the Utf16 alignment pad
+class Reader_
+{
+public:
+    explicit Reader_(const char* data)
+        : data_(data)
+    {
+    }
+
+    template <typename T> T scalar()
+    {
+        T value{};
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    Record::Tag tag() { return static_cast<Record::Tag>(scalar<quint8>()); }
+
+    QByteArrayView bytes()
+    {
+        auto size = scalar<qsizetype>();
+        if (size < 1)
+            return {};
+
+        QByteArrayView view(data_ + pos_, size);
+        pos_ += size;
+        return view;
+    }
+
+    // Call after reading the Utf16 tag
+    QStringView utf16()
+    {
+        auto size = scalar<qsizetype>();
+        pos_ += pos_ % qsizetype(alignof(char16_t));
+
+        if (size < 1)
+            return {};
+
+        QStringView view(
+            reinterpret_cast<const char16_t*>(data_ + pos_),
+            size);
+        pos_ += size * qsizetype(sizeof(char16_t));
+        return view;
+    }
+
+private:
+    const char* data_;
+    qsizetype pos_ = 0;
+};
+
+} // namespace
+
+QString Record::render() const
+{
+    Reader_ reader(data_());
+    QString utf8_format{};
+    QStringView format{};
+
+    if (formatInPayload_) {
+        reader.tag();
+        format = reader.utf16();
+    } else {
+        utf8_format = QString::fromUtf8(formatUtf8_);
+        format = utf8_format;
+    }
+
+    // Same as Log::print: no args means no walk (so no brace unescaping)
+    if (argCount_ < 1)
+        return format.toString();
+
+    auto values = std::make_unique<Fmt::Internal::ArgView_[]>(argCount_);
+
+    for (auto i = 0; i < argCount_; ++i) {
+        auto& value = values[i];
+
+        switch (reader.tag()) {
+        // Numbers stay raw, so the template's specs still apply
+        case Tag::Int:
+            value.setInt(reader.scalar<qint64>());
+            continue;
+        case Tag::UInt:
+            value.setUInt(reader.scalar<quint64>());
+            continue;
+        case Tag::Float:
+            value.setFloat(reader.scalar<float>());
+            continue;
+        case Tag::Double:
+            value.setDouble(reader.scalar<double>());
+            continue;
+        case Tag::Bool:
+            value.owned = reader.scalar<quint8>() ? u"true"_s : u"false"_s;
+            break;
+        case Tag::Utf16:
+            // Borrowed straight from the payload
+            value.view = reader.utf16();
+            continue;
+        case Tag::Utf8:
+            value.owned = QString::fromUtf8(reader.bytes());
+            break;
+        case Tag::Latin1: {
+            auto bytes = reader.bytes();
+            value.owned =
+                QLatin1StringView(bytes.data(), bytes.size()).toString();
+            break;
+        }
+        case Tag::Object: {
+            auto class_name = reader.scalar<const char*>();
+            auto address = reader.scalar<const void*>();
+            value.owned = class_name
+                              ? QString::asprintf("%s(%p)", class_name, address)
+                              : u"nullptr"_s;
+            break;
+        }
+        }
+
+        value.view = value.owned;
+    }
+
+    return Fmt::Internal::format_(format, values.get(), argCount_);
+}
+
+} // namespace Coco::Debug
@@ -0,0 +1,434 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/LogSink.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QtLogging>
+
+#include "Coco/Debug.h"
+
+namespace Coco::Debug {
+
+namespace Internal {
+
+constinit std::atomic<bool> hasSinks_{ false };
+
+} // namespace Internal
+
+namespace {
+
+std::atomic<quint64> droppedLines_{ 0 };
+
+class Sink_ : public std::enable_shared_from_this<Sink_>
+{
+public:
+    Sink_(
+        SinkId id,
+        LogSink lineSink,
+        BatchLogSink batchSink,
+        const SinkOptions& options)
+        : id(id)
+        , lineSink_(std::move(lineSink))
+        , batchSink_(std::move(batchSink))
+        , floor_(severity(options.level))
+        , delivery_(
+              options.delivery == SinkDelivery::Posted && !options.context
+                  ? SinkDelivery::Inline
+                  : options.delivery)
+        , context_(options.context)
+        , capacity_(options.capacity)
+    {
+    }
+
+    // Detached only if the last reference went away on the sink's own thread,
+    // which by then is on its way out of run_
+    ~Sink_()
+    {
+        if (thread_.joinable())
+            thread_.detach();
+    }
+
+    const SinkId id;
+
+    // Separate from the constructor, since the thread keeps the sink alive
+    void start()
+    {
+        if (delivery_ != SinkDelivery::Queued)
+            return;
+
+        thread_ = std::thread([self = shared_from_this()] { self->run_(); });
+    }
+
+    // Joins, unless called from the sink itself (then the thread just ends
+    // after the current batch)
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+
+        ready_.notify_one();
+        idle_.notify_all();
+
+        if (thread_.joinable() &&
+            thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+    }
+
+    void deliver(QtMsgType type, const QString& line)
+    {
+        if (severity(type) < floor_)
+            return;
+
+        if (delivery_ == SinkDelivery::Inline) {
+            if (lineSink_)
+                lineSink_(line);
+            else
+                batchSink_(QStringList{ line });
+
+            return;
+        }
+
+        auto was_empty = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_)
+                return;
+
+            // If the context is already gone, so is this sink (see add_)
+            if (delivery_ == SinkDelivery::Posted && !context_)
+                return;
+
+            if (capacity_ > 0 && pending_.size() >= capacity_) {
+                droppedLines_.fetch_add(1, std::memory_order::relaxed);
+                return;
+            }
+
+            was_empty = pending_.isEmpty();
+            pending_ << line;
+
+            // Posted under the lock (which only queues the call), so the
+            // context can't be destroyed partway through (see detachContext)
+            if (delivery_ == SinkDelivery::Posted && !posted_) {
+                posted_ = true;
+                QMetaObject::invokeMethod(
+                    context_,
+                    [self = shared_from_this()] { self->drainPosted_(); },
+                    Qt::QueuedConnection);
+            }
+        }
+
+        // The thread only sleeps when there's nothing pending
+        if (delivery_ == SinkDelivery::Queued && was_empty)
+            ready_.notify_one();
+    }
+
+    // From the context's destroyed signal, on whichever thread destroys it.
+    // Waits out a post in progress; later lines are dropped
+    void detachContext()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        context_ = nullptr;
+    }
+
+    // Waits for a Queued sink to go idle. Posted sinks run on someone else's
+    // event loop, so there's nothing to wait on (and it could deadlock)
+    void flush()
+    {
+        if (delivery_ != SinkDelivery::Queued ||
+            thread_.get_id() == std::this_thread::get_id()) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] {
+            return stopping_ || (pending_.isEmpty() && !busy_);
+        });
+    }
+
+private:
+    LogSink lineSink_;
+    BatchLogSink batchSink_;
+    int floor_;
+    SinkDelivery delivery_;
+    QObject* context_; // Guarded by mutex_
+    int capacity_;
+
+    std::mutex mutex_{};
+    std::condition_variable ready_{};
+    std::condition_variable idle_{};
+    QStringList pending_{};
+    bool stopping_ = false;
+    bool busy_ = false;
+    bool posted_ = false;
+    std::thread thread_{};
+
+    void call_(const QStringList& lines)
+    {
+        if (batchSink_) {
+            batchSink_(lines);
+            return;
+        }
+
+        for (auto& line : lines)
+            lineSink_(line);
+    }
+
+    void run_()
+    {
+        while (true) {
+            QStringList lines{};
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] {
+                    return stopping_ || !pending_.isEmpty();
+                });
+
+                // Stopping, and everything pending has been delivered
+                if (pending_.isEmpty())
+                    break;
+
+                lines.swap(pending_);
+                busy_ = true;
+            }
+
+            call_(lines);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busy_ = false;
+            }
+
+            idle_.notify_all();
+        }
+    }
+
+    // Runs on the context's thread
+    void drainPosted_()
+    {
+        QStringList lines{};
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_)
+                return;
+
+            lines.swap(pending_);
+            posted_ = false;
+        }
+
+        if (!lines.isEmpty())
+            call_(lines);
+    }
+};
+
+using SinkList_ = std::vector<std::shared_ptr<Sink_>>;
+
+struct Registry_
+{
+    // Copied (not held) by fanOut_, so sinks run without the lock, and adding
+    // or removing one never waits on a sink
+    std::mutex mutex{};
+    std::shared_ptr<const SinkList_> sinks = std::make_shared<SinkList_>();
+    SinkId nextId = 1;
+    SinkId legacyId = 0;
+};
+
+// Never destroyed: the async writer (in another TU) may still fan out during
+// static destruction
+Registry_& registry_()
+{
+    static auto registry = new Registry_{};
+    return *registry;
+}
+
+// Call with the registry's mutex held
+void publish_(Registry_& registry, SinkList_ sinks)
+{
+    Internal::hasSinks_.store(!sinks.empty(), std::memory_order::release);
+    registry.sinks = std::make_shared<const SinkList_>(std::move(sinks));
+}
+
+SinkId
+add_(LogSink lineSink, BatchLogSink batchSink, const SinkOptions& options)
+{
+    if (!lineSink && !batchSink)
+        return 0;
+
+    auto& registry = registry_();
+    std::shared_ptr<Sink_> sink{};
+
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        sink = std::make_shared<Sink_>(
+            registry.nextId++,
+            std::move(lineSink),
+            std::move(batchSink),
+            options);
+        sink->start();
+
+        auto sinks = *registry.sinks;
+        sinks.push_back(sink);
+        publish_(registry, std::move(sinks));
+    }
+
+    if (options.delivery == SinkDelivery::Posted && options.context) {
+        // Direct, so the sink lets go of the context before it's gone
+        QObject::connect(
+            options.context,
+            &QObject::destroyed,
+            [weak = std::weak_ptr<Sink_>(sink), id = sink->id] {
+                if (auto live = weak.lock())
+                    live->detachContext();
+
+                removeLogSink(id);
+            });
+    }
+
+    return sink->id;
+}
+
+// Stops queued sinks at exit, so whatever they have pending is delivered
+struct SinksGuard_
+{
+    ~SinksGuard_()
+    {
+        auto& registry = registry_();
+        std::shared_ptr<const SinkList_> sinks{};
+
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            sinks = std::exchange(registry.sinks, {});
+            publish_(registry, {});
+        }
+
+        for (auto& sink : *sinks)
+            sink->stop();
+    }
+} sinksGuard_{};
+
+} // namespace
+
+SinkId addLogSink(LogSink sink, const SinkOptions& options)
+{
+    return add_(std::move(sink), {}, options);
+}
+
+SinkId addBatchLogSink(BatchLogSink sink, const SinkOptions& options)
+{
+    return add_({}, std::move(sink), options);
+}
+
+void removeLogSink(SinkId id)
+{
+    auto& registry = registry_();
+    std::shared_ptr<Sink_> removed{};
+
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        SinkList_ sinks{};
+
+        for (auto& sink : *registry.sinks) {
+            if (sink->id == id)
+                removed = sink;
+            else
+                sinks.push_back(sink);
+        }
+
+        if (!removed)
+            return;
+
+        publish_(registry, std::move(sinks));
+    }
+
+    removed->stop();
+}
+
+void setLogSink(LogSink sink)
+{
+    auto& registry = registry_();
+    SinkId old_id{};
+
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        old_id = std::exchange(registry.legacyId, 0);
+    }
+
+    if (old_id)
+        removeLogSink(old_id);
+
+    auto id = addLogSink(std::move(sink));
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.legacyId = id;
+}
+
+namespace Internal {
+
+void fanOut_(QtMsgType type, const QString& line)
+{
+    if (!hasSinks_.load(std::memory_order::acquire))
+        return;
+
+    auto& registry = registry_();
+    std::shared_ptr<const SinkList_> sinks{};
+
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        sinks = registry.sinks;
+    }
+
+    for (auto& sink : *sinks)
+        sink->deliver(type, line);
+}
+
+void flushSinks_()
+{
+    if (!hasSinks_.load(std::memory_order::acquire))
+        return;
+
+    auto& registry = registry_();
+    std::shared_ptr<const SinkList_> sinks{};
+
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        sinks = registry.sinks;
+    }
+
+    for (auto& sink : *sinks)
+        sink->flush();
+}
+
+quint64 sinkDropped_() noexcept
+{
+    return droppedLines_.load(std::memory_order::relaxed);
+}
+
+} // namespace Internal
+
+} // namespace Coco::Debug
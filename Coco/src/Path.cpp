@@ -17,8 +17,11 @@
 #include <QString>
 #include <QVariant>
 
+#include "Coco/ToQString.h"
+
 // Registers Path with Qt's meta-type system and adds bidirectional QString
-// converters, allowing Path to be stored in and retrieved from QVariant
+// converters, allowing Path to be stored in and retrieved from QVariant (and
+// rendered by toQString without a converter lookup)
 static const int qMetaTypeInitializer_ = [] {
     constexpr auto name = "Coco::Path";
 
@@ -27,6 +30,7 @@ static const int qMetaTypeInitializer_ = [] {
         [](const Coco::Path& p) { return p.toQString(); });
     QMetaType::registerConverter<QString, Coco::Path>(
         [](const QString& s) { return Coco::Path(s); });
+    Coco::registerQStringRenderer<Coco::Path>();
 
 #ifdef COCO_HAS_DIAGNOSTICS
 
@@ -0,0 +1,269 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/Scan.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <QFileInfo>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QThread>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+#include "DirReader.h"
+
+namespace Coco {
+
+namespace {
+
+// Collects Paths, or DirEntries (for scanEntries)
+template <typename T> class Scanner_
+{
+public:
+    Scanner_(const ScanOptions& options, int workers)
+        : options_(options)
+    {
+        for (auto i = 0; i < workers; ++i)
+            queues_.push_back(std::make_unique<Queue_>());
+    }
+
+    QList<QList<T>> run(const PathList& dirs)
+    {
+        auto workers = int(queues_.size());
+
+        // Dealt out round-robin, so every worker starts with something if
+        // there are enough roots
+        for (qsizetype i = 0; i < dirs.size(); ++i)
+            if (visit_(dirs[i]))
+                push_(int(i % workers), dirs[i]);
+
+        QList<QList<T>> chunks(workers);
+        std::vector<std::thread> threads{};
+
+        for (auto i = 1; i < workers; ++i)
+            threads.emplace_back([this, i, &chunks] { work_(i, chunks[i]); });
+
+        work_(0, chunks[0]);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        return chunks;
+    }
+
+private:
+    struct Queue_
+    {
+        std::mutex mutex{};
+        std::deque<Path> dirs{};
+    };
+
+    const ScanOptions& options_;
+    std::vector<std::unique_ptr<Queue_>> queues_{};
+
+    // Directories queued, and queued or being listed. The walk is over when
+    // nothing is pending (no worker is listing, so none can queue more)
+    std::atomic<qsizetype> queued_{ 0 };
+    std::atomic<qsizetype> pending_{ 0 };
+    std::mutex idleMutex_{};
+    std::condition_variable idle_{};
+
+    // With FollowSymlinks, every directory entered (by canonical path), so a
+    // link back up the tree isn't followed twice
+    std::mutex visitedMutex_{};
+    QSet<QString> visited_{};
+
+    void push_(int worker, Path dir)
+    {
+        auto& queue = *queues_[worker];
+
+        // Counted before it's visible, or a thief could finish it first and
+        // see nothing pending while this worker is still listing
+        ++pending_;
+        ++queued_;
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.dirs.push_back(std::move(dir));
+        }
+
+        // Taken (even empty) so a worker between checking queued_ and waiting
+        // can't miss this
+        {
+            std::lock_guard<std::mutex> lock(idleMutex_);
+        }
+
+        idle_.notify_one();
+    }
+
+    // Own queue newest-first (depth-first, warm caches), others' oldest-first
+    bool take_(int worker, Path& dir)
+    {
+        auto workers = int(queues_.size());
+
+        while (true) {
+            for (auto i = 0; i < workers; ++i) {
+                auto& queue = *queues_[(worker + i) % workers];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+
+                if (queue.dirs.empty())
+                    continue;
+
+                if (i == 0) {
+                    dir = std::move(queue.dirs.back());
+                    queue.dirs.pop_back();
+                } else {
+                    dir = std::move(queue.dirs.front());
+                    queue.dirs.pop_front();
+                }
+
+                --queued_;
+                return true;
+            }
+
+            std::unique_lock<std::mutex> lock(idleMutex_);
+            idle_.wait(lock, [&] { return queued_ > 0 || pending_ == 0; });
+
+            if (pending_ == 0)
+                return false;
+        }
+    }
+
+    void done_()
+    {
+        if (--pending_ == 0) {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+            }
+
+            idle_.notify_all();
+        }
+    }
+
+    // False if the directory was already entered (only tracked with
+    // FollowSymlinks, as QDirIterator does)
+    bool visit_(const Path& dir)
+    {
+        if (!(options_.flags & QDirIterator::FollowSymlinks))
+            return true;
+
+        auto canonical = QFileInfo(dir.toQString()).canonicalFilePath();
+        std::lock_guard<std::mutex> lock(visitedMutex_);
+
+        if (visited_.contains(canonical))
+            return false;
+
+        visited_.insert(canonical);
+        return true;
+    }
+
+    void work_(int worker, QList<T>& out)
+    {
+        Internal::EntryFilter filter(
+            options_.exts,
+            options_.filters,
+            options_.flags);
+
+        Internal::ListedEntry entry{};
+
+        for (Path dir{}; take_(worker, dir); done_()) {
+            Internal::DirReader reader(dir.toQString());
+            auto prefix = dir.toQString();
+
+            if (!prefix.isEmpty() && !prefix.endsWith(u'/') &&
+                !prefix.endsWith(QDir::separator()))
+                prefix += u'/';
+
+            while (reader.next(entry)) {
+                auto matches = filter.matches(reader, entry);
+                auto descends = filter.descends(entry);
+
+                if (!matches && !descends)
+                    continue;
+
+                Path path(prefix + entry.name);
+
+                if (descends && !(options_.prune && options_.prune(path)) &&
+                    visit_(path))
+                    push_(worker, path);
+
+                if (!matches)
+                    continue;
+
+                if constexpr (std::is_same_v<T, DirEntry>) {
+                    auto has_stat = options_.stat && reader.stat(entry);
+                    out << entry.toDirEntry(std::move(path), has_stat);
+                } else {
+                    out << std::move(path);
+                }
+            }
+        }
+    }
+};
+
+template <typename T>
+QList<QList<T>> chunks_(const PathList& dirs, const ScanOptions& options)
+{
+    auto workers =
+        options.threads > 0 ? options.threads : QThread::idealThreadCount();
+
+    Scanner_<T> scanner(options, qMax(workers, 1));
+    return scanner.run(dirs);
+}
+
+template <typename T> QList<T> merged_(const QList<QList<T>>& chunks)
+{
+    qsizetype total = 0;
+
+    for (auto& chunk : chunks)
+        total += chunk.size();
+
+    QList<T> result{};
+    result.reserve(total);
+
+    for (auto& chunk : chunks)
+        result << chunk;
+
+    return result;
+}
+
+} // namespace
+
+QList<PathList> scanChunks(const PathList& dirs, const ScanOptions& options)
+{
+    return chunks_<Path>(dirs, options);
+}
+
+PathList scan(const PathList& dirs, const ScanOptions& options)
+{
+    return merged_(chunks_<Path>(dirs, options));
+}
+
+DirEntryList scanEntries(const PathList& dirs, const ScanOptions& options)
+{
+    return merged_(chunks_<DirEntry>(dirs, options));
+}
+
+} // namespace Coco
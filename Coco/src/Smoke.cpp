@@ -19,19 +19,38 @@
 //   2. Path meta-type converter registration (runtime; proves Path.cpp linked)
 //   3. StartCop meta-object linkage (link-time; proves AUTOMOC ran)
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
 #include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
 #if defined(COCO_HAS_XML)
 #    include <QDomDocument>
 #endif
+#include <QFile>
 #include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QTemporaryDir>
 #include <QVariant>
+#include <QVariantMap>
 
 #include <Coco/Debug.h>
+#include <Coco/Disk.h>
+#include <Coco/FileIndex.h>
 #include <Coco/Path.h>
+#include <Coco/Scan.h>
+#include <Coco/StatCache.h>
 #if defined(COCO_HAS_NETWORK)
 #    include <Coco/StartCop.h>
 #endif
 #include <Coco/ToQString.h>
+#include <Coco/Walk.h>
 
 // COCO_TEST_EXPECT_* come from this test's own CMake and encode what the
 // configure step requested, independent of Coco. Cross-checking them against
@@ -57,6 +76,8 @@ static_assert(
     "COCO_HAS_NETWORK is not defined but the build configured Network ON");
 #endif
 
+COCO_LOG_CATEGORY(smokeLog, "smoke.net");
+
 static int failures = 0;
 
 static void check(bool ok, const char* what)
@@ -64,7 +85,7 @@ static void check(bool ok, const char* what)
     if (ok) {
         INFO("ok  : {}", what);
     } else {
-        WARN("FAIL:", what);
+        WARN("FAIL: {}", what);
         ++failures;
     }
 }
@@ -75,7 +96,8 @@ int main(int argc, char* argv[])
 
     QCoreApplication app(argc, argv);
 
-    Coco::Debug::initialize(true);
+    Coco::Debug::init(true);
+    Coco::Debug::startAsync();
 
     // --- Path converter registration --------------------------------------
     // The converters are installed ONLY by Path.cpp's static initializer, and
@@ -98,10 +120,425 @@ int main(int argc, char* argv[])
         fromString.value<Coco::Path>() == Coco::Path("a/b/c.md"),
         "QString -> Path round-trips");
 
+    // --- Shared Paths across threads --------------------------------------
+    // Copies share one buffer, read from every thread at once
+    Coco::Path shared("x/y/shared.txt");
+    Coco::PathList copies(8, shared);
+    std::atomic<int> matches{ 0 };
+    std::vector<std::thread> readers{};
+
+    for (auto& copy : copies) {
+        readers.emplace_back([&] {
+            if (copy.toQString() == u"x/y/shared.txt"_s &&
+                copy.toString() == "x/y/shared.txt")
+                ++matches;
+        });
+    }
+
+    for (auto& reader : readers)
+        reader.join();
+
+    check(matches == 8, "Shared Paths read safely from many threads");
+
+    // --- Path decomposition -----------------------------------------------
+    // Views into the one buffer, by the same grammar as std::filesystem
+    auto decomposes = true;
+    auto orders = true;
+    const char* samples[] = { "",        "/",     "a",      "a/",
+                              "//a/b.c", "a//b/", "a/.cfg", "a/..",
+                              "a.b.c",   "C:",    "C:/a/b", "./a.b/c" };
+
+    for (auto sample : samples) {
+        Coco::Path path(sample);
+        std::filesystem::path std_path(sample);
+        auto same = [](QStringView view, const std::filesystem::path& p) {
+            return view == Coco::Path(p).toQString();
+        };
+
+        decomposes = decomposes &&
+                     same(path.rootNameView(), std_path.root_name()) &&
+                     same(path.rootView(), std_path.root_path()) &&
+                     same(path.relativeView(), std_path.relative_path()) &&
+                     same(path.parentView(), std_path.parent_path()) &&
+                     same(path.nameView(), std_path.filename()) &&
+                     same(path.stemView(), std_path.stem()) &&
+                     same(path.extView(), std_path.extension());
+
+        for (auto other : samples) {
+            orders = orders && (path <=> Coco::Path(other)) ==
+                                   (std_path.compare(other) <=> 0);
+        }
+    }
+
+    check(decomposes, "Path decomposes like std::filesystem::path");
+    check(orders, "Path orders like std::filesystem::path");
+
     // --- ToQString core paths (no optional modules) -----------------------
     check(Coco::toQString(42) == u"42"_s, "toQString(int)");
     check(Coco::toQString(u"hi"_s) == u"hi"_s, "toQString(QString)");
 
+    // Nested containers render into one buffer (appendQString all the way down)
+    QVariantMap nested{ { u"a"_s, 1 },
+                        { u"b"_s, QVariantMap{ { u"c"_s, true } } } };
+    auto streamed = u"> "_s;
+    Coco::appendQString(streamed, nested);
+    check(
+        streamed == u"> QVariantMap({ \"a\", 1 }, "
+                    u"{ \"b\", QVariantMap({ \"c\", true }) })"_s,
+        "appendQString(QVariantMap) streams nested values");
+
+    // Path registers a renderer (Path.cpp), so no converter lookup
+    check(
+        Coco::toQString(QVariant::fromValue(Coco::Path("a/b.txt"))) ==
+            u"a/b.txt"_s,
+        "toQString(QVariant) dispatches registered types");
+
+    // Per-call render limits: elements per container, then nesting depth
+    QStringList many{ u"a"_s, u"b"_s, u"c"_s, u"d"_s, u"e"_s };
+    check(
+        Coco::toQString(many, { .maxElements = 2 }) ==
+                u"a, b, ... (+3 more)"_s &&
+            Coco::toQString(nested, { .maxDepth = 1 }) ==
+                u"QVariantMap({ \"a\", 1 }, { \"b\", QVariantMap(...) })"_s,
+        "toQString honors RenderLimits");
+
+    // --- Lazy arguments ---------------------------------------------------
+    auto evaluated = 0;
+    auto lazy = Coco::Fmt::lazy([&] { return ++evaluated; });
+    check(
+        Coco::Fmt::format(u"{}", lazy) == u"1"_s && evaluated == 1,
+        "Fmt::lazy evaluates once, when formatted");
+
+    check(
+        Coco::Fmt::format(
+            u"{:x} {:.3f} {}",
+            Coco::Fmt::lazy([] { return 255; }),
+            Coco::Fmt::lazy([] { return 0.5; }),
+            Coco::Fmt::lazy([] { return u"text"_s; })) == u"ff 0.500 text"_s,
+        "Fmt::lazy numbers still take specs");
+
+    // --- Compile-time templates -------------------------------------------
+    check(
+        Coco::Fmt::FormatString<int>(u"{{{}}}").isParsed() &&
+            Coco::Fmt::format(u"{{{}}}", 7) == u"{7}"_s &&
+            Coco::Fmt::format(QString(u"{{{}}}"_s), 7) == u"{7}"_s,
+        "Fmt literal templates are parsed at compile time, same output");
+
+    // --- Format specs -----------------------------------------------------
+    check(
+        Coco::Fmt::format(u"{:08x}|{:.3f}|{:>5}", 255, 2.0, u"ab"_s) ==
+            u"000000ff|2.000|   ab"_s,
+        "Fmt specs (width, precision, hex, alignment)");
+
+    Coco::Debug::Record
+        spec_record(QtInfoMsg, __FILE__, __LINE__, "main", nullptr);
+    spec_record.setFormat("{:#x} {:+.1f}");
+    spec_record.append(255);
+    spec_record.append(2.3);
+    check(
+        spec_record.render() == u"0xff +2.3"_s,
+        "Record::render applies specs to raw numbers");
+
+    // --- Number fast paths ------------------------------------------------
+    check(
+        Coco::Fmt::format(u"{} {} {}", 0.1, 0.1f, -42) == u"0.1 0.1 -42"_s &&
+            Coco::Fmt::formattedSize(u"{}", 3.14159265358979) == 16,
+        "Fmt numbers use shortest round-trip text, sized exactly");
+
+    // --- Caller-owned buffers ---------------------------------------------
+    QString reused = u"> "_s;
+    Coco::Fmt::formatTo(reused, "{} of {}", 3, 4);
+    Coco::Fmt::SmallString<4> small{};
+    Coco::Fmt::formatTo(small, "{:>6}", u"spills"_s);
+    check(
+        reused == u"> 3 of 4"_s && small.view() == u"spills" &&
+            Coco::Fmt::formattedSize("{{{}}}", 12) == 4 &&
+            Coco::Fmt::formatExact("{{{}}}", 12) == u"{12}"_s,
+        "Fmt::formatTo, SmallString and exact sizing");
+
+    // --- Long literal runs ------------------------------------------------
+    // Braces either side of a vector-width boundary, found by the SIMD scan
+    auto dashes = QString(37, u'-');
+    auto dots = QString(21, u'.');
+    check(
+        Coco::Fmt::format(dashes + u"{}}}"_s + dots + u"{{{}"_s, 1, 2) ==
+                dashes + u"1}"_s + dots + u"{2"_s &&
+            Coco::Path("C:\\some\\deeply//nested\\\\windows/dir\\")
+                    .prettyString() == "C:/some/deeply/nested/windows/dir",
+        "Fmt and Path scan long runs a vector at a time");
+
+    // --- Structured log records -------------------------------------------
+    // Deferred rendering has to come out the same as formatting up front
+    Coco::Debug::Record record(QtInfoMsg, __FILE__, __LINE__, "main", nullptr);
+    record.setFormat("{} + {} = {} ({}, {})");
+    record.append(1);
+    record.append(2.5);
+    record.append(u"three"_s);
+    record.append(true);
+    record.append("four");
+    check(
+        record.render() == Coco::Fmt::format(
+                               u"{} + {} = {} ({}, {})",
+                               1,
+                               2.5,
+                               u"three"_s,
+                               true,
+                               "four"),
+        "Record::render matches Fmt::format");
+
+    // --- Log categories ---------------------------------------------------
+    Coco::Debug::setLogRules(u"smoke.*=warning; smoke.net=debug");
+    CDEBUG(smokeLog, "category: {}", smokeLog.name());
+    check(
+        Coco::Debug::isEnabled(smokeLog, QtDebugMsg) &&
+            !Coco::Debug::isEnabled(
+                Coco::Debug::category("smoke.ui"),
+                QtInfoMsg),
+        "Log rules set category levels");
+    Coco::Debug::setLogRules({});
+
+    // --- Log sinks --------------------------------------------------------
+    // A Queued batch sink on its own thread, filtered to warnings and up
+    std::atomic<int> sunk{ 0 };
+    auto sink_id = Coco::Debug::addBatchLogSink(
+        [&](const QStringList& lines) { sunk += lines.size(); },
+        { QtWarningMsg, Coco::Debug::SinkDelivery::Queued });
+    DEBUG("sink: filtered out");
+    WARN("sink: delivered");
+    Coco::Debug::flush();
+    check(sunk == 1, "Queued sink gets lines at its level");
+    Coco::Debug::removeLogSink(sink_id);
+
+    // --- Log pruning by total size ----------------------------------------
+    // Four 100-byte files under a 250-byte budget: the two newest survive
+    QTemporaryDir tmp{};
+    Coco::Path tmp_dir(tmp.path());
+
+    for (auto name : { "p_1.log", "p_2.log.qz", "p_3.log", "p_4.log" }) {
+        QFile file((tmp_dir / name).toQString());
+        file.open(QIODevice::WriteOnly);
+        file.write(QByteArray(100, 'x'));
+    }
+
+    Coco::Disk::prune(tmp_dir, u"p_"_s, { u".log"_s, u".log.qz"_s }, 0, 250);
+    check(
+        !(tmp_dir / "p_2.log.qz").exists() && (tmp_dir / "p_3.log").exists() &&
+            (tmp_dir / "p_4.log").exists(),
+        "Disk::prune respects a byte budget");
+
+    // --- Parallel scan ----------------------------------------------------
+    // Same entries as QDirIterator, in whatever order (paths() too, now that
+    // it walks with Coco's own reader)
+    for (auto dir : { "a/b/c", "a/.hidden", "d" })
+        Coco::mkpath(tmp_dir / dir);
+
+    for (auto name : { "x.txt",
+                       "y.TXT",
+                       "a/m.md",
+                       "a/.h.txt",
+                       "a/b/n.txt",
+                       "a/b/c/o.txt",
+                       "a/.hidden/h.txt" }) {
+        QFile file((tmp_dir / name).toQString());
+        file.open(QIODevice::WriteOnly);
+    }
+
+    auto sorted = [](Coco::PathList list) {
+        std::sort(list.begin(), list.end());
+        return list;
+    };
+
+    auto finds_like_qt = [&](const QStringList& exts,
+                             QDir::Filters filters,
+                             QDirIterator::IteratorFlags flags) {
+        Coco::PathList iterated{};
+        QDirIterator it(tmp_dir.toQString(), exts, filters, flags);
+
+        while (it.hasNext())
+            iterated << it.next();
+
+        iterated = sorted(iterated);
+
+        return sorted(Coco::scan(
+                   tmp_dir,
+                   { .exts = exts,
+                     .filters = filters,
+                     .flags = flags,
+                     .threads = 4 })) == iterated &&
+               sorted(Coco::paths(tmp_dir, exts, filters, flags)) == iterated;
+    };
+
+    auto all = QDir::AllEntries | QDir::NoDotAndDotDot;
+    auto deep = QDirIterator::Subdirectories;
+
+    check(
+        finds_like_qt({}, all, deep) &&
+            finds_like_qt({ u"*.txt"_s }, QDir::Files, deep) &&
+            finds_like_qt({}, QDir::Files | QDir::Hidden, deep) &&
+            finds_like_qt({}, QDir::Dirs | QDir::NoDotAndDotDot, deep) &&
+            finds_like_qt({ u"*.md"_s }, all, QDirIterator::NoIteratorFlags),
+        "Coco::scan and paths() find what QDirIterator finds");
+
+    // --- Lazy walk --------------------------------------------------------
+    // Stops at the break, stays within maxDepth, and skips pruned contents
+    auto walked = 0;
+
+    for (auto& path : Coco::walk(tmp_dir)) {
+        Q_UNUSED(path);
+        if (++walked == 2)
+            break;
+    }
+
+    auto shallow = true;
+    auto limited = Coco::walk(tmp_dir, { .maxDepth = 1 });
+
+    for (auto& path : limited)
+        shallow = shallow && limited.depth() <= 1 && path != tmp_dir / "a/b/c";
+
+    Coco::PathList unpruned{};
+
+    for (auto& path : Coco::walk(
+             tmp_dir,
+             { .filters = QDir::Files,
+               .prune = [](const Coco::Path& dir) {
+                   return dir.nameView() == u"b";
+               } }))
+        unpruned << path;
+
+    check(
+        walked == 2 && shallow &&
+            sorted(unpruned) ==
+                sorted({ tmp_dir / "x.txt",
+                         tmp_dir / "y.TXT",
+                         tmp_dir / "a/m.md" }),
+        "Coco::walk breaks early, limits depth and prunes");
+
+    // --- Directory entries ------------------------------------------------
+    // Type, size and mtime come with the listing (the two logs prune kept)
+    auto logs = Coco::dirEntries(tmp_dir, { u"p_*"_s }, QDir::Files);
+    auto described = logs.size() == 2;
+
+    for (auto& entry : logs) {
+        described = described && entry.isFile() && !entry.isDir() &&
+                    entry.hasStat() && entry.size() == 100 &&
+                    entry.lastModified().isValid();
+    }
+
+    check(described, "dirEntries carries stat data from the walk");
+
+    // --- Stat cache -------------------------------------------------------
+    // Answers stand until invalidated (no ttl here), then are asked again
+    Coco::StatCache stat_cache({ .ttl = std::chrono::milliseconds(0) });
+    auto cached = tmp_dir / "cached.txt";
+
+    {
+        QFile file(cached.toQString());
+        file.open(QIODevice::WriteOnly);
+    }
+
+    auto memoized = stat_cache.isFile(cached) && stat_cache.isFile(cached);
+    Coco::remove(cached);
+    auto stale = stat_cache.exists(cached);
+    auto counts = stat_cache.stats();
+    stat_cache.invalidate(cached);
+
+    check(
+        memoized && stale && counts.hits == 2 && counts.misses == 1 &&
+            !stat_cache.exists(cached),
+        "StatCache answers from memory until invalidated");
+
+    // --- File index -------------------------------------------------------
+    // Hidden files are left out, and extensions match case-insensitively
+    Coco::FileIndex file_index({ tmp_dir }, { .exts = { u"*.txt"_s } });
+
+    check(
+        file_index.size() == 4 && file_index.contains(tmp_dir / "a/b/n.txt") &&
+            !file_index.contains(tmp_dir / "a/.h.txt") &&
+            file_index.withExtension(u".txt").size() == 4 &&
+            sorted(file_index.subtree(tmp_dir / "a")) ==
+                sorted({ tmp_dir / "a/b/n.txt", tmp_dir / "a/b/c/o.txt" }),
+        "FileIndex indexes what a scan finds");
+
+    // --- File index updates -----------------------------------------------
+    // A file and a directory made, renamed and deleted behind its back, seen
+    // once the event loop runs
+    Coco::PathList index_added{};
+    Coco::PathList index_removed{};
+
+    QObject::connect(
+        &file_index,
+        &Coco::FileIndex::filesAdded,
+        [&](const Coco::PathList& paths) { index_added << paths; });
+
+    QObject::connect(
+        &file_index,
+        &Coco::FileIndex::filesRemoved,
+        [&](const Coco::PathList& paths) { index_removed << paths; });
+
+    // Until done, or a few seconds pass
+    auto settle = [](auto done) {
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (!done() && std::chrono::steady_clock::now() < deadline) {
+            QCoreApplication::processEvents();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    };
+
+    auto touch = [](const Coco::Path& path) {
+        QFile file(path.toQString());
+        file.open(QIODevice::WriteOnly);
+    };
+
+    Coco::mkpath(tmp_dir / "d/e");
+    touch(tmp_dir / "d/e/f.txt");
+    touch(tmp_dir / "new.txt");
+    settle([&] { return index_added.size() == 2; });
+
+    auto made = index_removed.isEmpty() &&
+                sorted(index_added) ==
+                    sorted({ tmp_dir / "d/e/f.txt", tmp_dir / "new.txt" });
+
+    index_added.clear();
+    Coco::rename(tmp_dir / "new.txt", tmp_dir / "renamed.txt");
+    QDir(tmp_dir.toQString()).rename(u"d/e"_s, u"d/g"_s);
+    settle([&] {
+        return index_added.size() == 2 && index_removed.size() == 2;
+    });
+
+    auto renamed =
+        sorted(index_removed) ==
+            sorted({ tmp_dir / "d/e/f.txt", tmp_dir / "new.txt" }) &&
+        sorted(index_added) ==
+            sorted({ tmp_dir / "d/g/f.txt", tmp_dir / "renamed.txt" }) &&
+        file_index.contains(tmp_dir / "d/g/f.txt");
+
+    index_added.clear();
+    index_removed.clear();
+    Coco::remove(tmp_dir / "renamed.txt");
+    Coco::purge(tmp_dir / "d/g");
+    settle([&] { return index_removed.size() == 2; });
+
+    auto deleted =
+        index_added.isEmpty() && file_index.size() == 4 &&
+        sorted(index_removed) ==
+            sorted({ tmp_dir / "d/g/f.txt", tmp_dir / "renamed.txt" });
+
+    // What resync finds is emitted the same way (it's what a lost event, like
+    // an inotify queue overflow, falls back on)
+    index_removed.clear();
+    touch(tmp_dir / "late.txt");
+    file_index.resync();
+
+    auto resynced = index_removed.isEmpty() &&
+                    index_added == Coco::PathList{ tmp_dir / "late.txt" } &&
+                    file_index.contains(tmp_dir / "late.txt");
+
+    check(
+        made && renamed && deleted && resynced,
+        "FileIndex keeps up as files and directories change");
+
     // --- Optional: Qt Xml -------------------------------------------------
 #if defined(COCO_HAS_XML)
     QDomDocument doc;
@@ -128,5 +565,7 @@ int main(int argc, char* argv[])
 #endif
 
     INFO(failures ? "SMOKE TEST FAILED" : "smoke test passed");
+    Coco::Debug::flush();
+
     return failures ? 1 : 0;
 }
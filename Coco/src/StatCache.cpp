@@ -0,0 +1,250 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/StatCache.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+namespace Coco {
+
+StatCache::StatCache(const StatCacheOptions& options)
+    : options_(options)
+{
+}
+
+StatCache::~StatCache() { setWatcher(nullptr); }
+
+DirEntry StatCache::entry(const Path& path)
+{
+    std::uint64_t invalidations = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (auto record = find_(path)) {
+            ++hits_;
+            return record->entry;
+        }
+
+        invalidations = invalidations_;
+    }
+
+    ++misses_;
+
+    // Stamped before the stat, so an invalidateAll during it still counts
+    Record_ record{ {}, Clock_::now() + options_.ttl, generation_ };
+    record.entry = stat_(path);
+    auto result = record.entry;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Invalidated during the stat: the answer may predate the change
+    if (invalidations_ == invalidations)
+        insert_(std::move(record));
+
+    return result;
+}
+
+bool StatCache::isEmptyDir(const Path& path)
+{
+    if (!isDir(path))
+        return false;
+
+    std::uint64_t invalidations = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (auto record = find_(path); record && record->emptyDir >= 0)
+            return record->emptyDir == 1;
+
+        invalidations = invalidations_;
+    }
+
+    auto empty =
+        QDir(path.toQString()).isEmpty(QDir::AllEntries | QDir::NoDotAndDotDot);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (auto record = find_(path); record && invalidations_ == invalidations)
+        record->emptyDir = empty;
+
+    return empty;
+}
+
+void StatCache::invalidate(const Path& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++invalidations_;
+    erase_(path);
+
+    if (auto parent = index_.find(path.parent()); parent != index_.end())
+        (*parent)->emptyDir = -1;
+}
+
+void StatCache::invalidateDir(const Path& dir)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++invalidations_;
+    erase_(dir);
+
+    if (auto parent = index_.find(dir.parent()); parent != index_.end())
+        (*parent)->emptyDir = -1;
+
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        if (it->entry.path().parent() == dir) {
+            index_.remove(it->entry.path());
+            it = lru_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void StatCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++invalidations_;
+    index_.clear();
+    lru_.clear();
+}
+
+void StatCache::setWatcher(QFileSystemWatcher* watcher)
+{
+    QObject::disconnect(fileChanged_);
+    QObject::disconnect(directoryChanged_);
+
+    // A slot already running finishes before the guard is cleared, and any
+    // that start after find it empty
+    if (watchGuard_) {
+        std::lock_guard<std::mutex> lock(watchGuard_->mutex);
+        watchGuard_->cache = nullptr;
+        watchGuard_.reset();
+    }
+
+    if (!watcher)
+        return;
+
+    watchGuard_ = std::make_shared<WatchGuard_>();
+    watchGuard_->cache = this;
+
+    // No context object: these run on the watcher's thread, which the locks
+    // make safe
+    fileChanged_ = QObject::connect(
+        watcher,
+        &QFileSystemWatcher::fileChanged,
+        [guard = watchGuard_](const QString& path) {
+            std::lock_guard<std::mutex> lock(guard->mutex);
+            if (guard->cache)
+                guard->cache->invalidate(Path(path));
+        });
+
+    directoryChanged_ = QObject::connect(
+        watcher,
+        &QFileSystemWatcher::directoryChanged,
+        [guard = watchGuard_](const QString& path) {
+            std::lock_guard<std::mutex> lock(guard->mutex);
+            if (guard->cache)
+                guard->cache->invalidateDir(Path(path));
+        });
+}
+
+StatCacheStats StatCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return { hits_, misses_, index_.size() };
+}
+
+void StatCache::resetStats() noexcept
+{
+    hits_ = 0;
+    misses_ = 0;
+}
+
+DirEntry StatCache::stat_(const Path& path)
+{
+    // One stat, cached by QFileInfo for the questions after the first
+    QFileInfo info(path.toQString());
+    DirEntry entry{};
+
+    entry.path_ = path;
+    entry.exists_ = info.exists();
+    entry.isFile_ = info.isFile();
+    entry.isDir_ = info.isDir();
+    entry.isSymLink_ = info.isSymLink();
+    entry.isHidden_ = info.isHidden();
+
+    if (entry.exists_) {
+        entry.hasStat_ = true;
+        entry.size_ = info.size();
+        entry.modified_ = info.lastModified().toMSecsSinceEpoch();
+        entry.permissions_ = info.permissions();
+    }
+
+    return entry;
+}
+
+StatCache::Record_* StatCache::find_(const Path& path)
+{
+    auto it = index_.find(path);
+    if (it == index_.end())
+        return nullptr;
+
+    auto record = *it;
+    auto expired = options_.ttl.count() > 0 && Clock_::now() >= record->expires;
+
+    if (expired || record->generation != generation_) {
+        lru_.erase(record);
+        index_.erase(it);
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, record);
+    return &*record;
+}
+
+void StatCache::insert_(Record_ record)
+{
+    // Another thread may have missed on the same path meanwhile
+    erase_(record.entry.path());
+
+    lru_.push_front(std::move(record));
+    index_.insert(lru_.front().entry.path(), lru_.begin());
+
+    while (lru_.size() > size_t(qMax(options_.capacity, qsizetype(1)))) {
+        index_.remove(lru_.back().entry.path());
+        lru_.pop_back();
+    }
+}
+
+void StatCache::erase_(const Path& path)
+{
+    auto it = index_.find(path);
+    if (it == index_.end())
+        return;
+
+    lru_.erase(*it);
+    index_.erase(it);
+}
+
+} // namespace Coco
@@ -0,0 +1,192 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/ToQString.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLine>
+#include <QLineF>
+#include <QMetaType>
+#include <QModelIndex>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QStringList>
+#include <QVariantHash>
+#include <QVariantList>
+#include <QVariantMap>
+
+namespace Coco {
+
+namespace {
+
+// Set from Debug::setRenderLimits. Separate relaxed atomics: a render racing a
+// change may see a mix of old and new, which is harmless
+std::atomic<qsizetype> maxElements_{ 0 };
+std::atomic<int> maxDepth_{ 0 };
+std::atomic<qsizetype> maxSize_{ 0 };
+
+using Slots_ = std::vector<QStringRenderer>;
+
+// Flat, indexed by type id. Built-in ids and user ids (from QMetaType::User)
+// get separate vectors, since the gap between them is most of 64K
+struct Table_
+{
+    Slots_ builtin{};
+    Slots_ user{};
+};
+
+struct Registry_
+{
+    std::mutex mutex{};
+    std::atomic<const Table_*> current{ nullptr };
+
+    // Every table ever published. Lookups don't lock, so a replaced table may
+    // still be in use and is never freed (registration is rare, and usually
+    // done once at startup)
+    std::vector<std::unique_ptr<const Table_>> tables{};
+};
+
+// Call with the registry's mutex held
+void publish_(Registry_& registry, Table_ table)
+{
+    auto published = std::make_unique<const Table_>(std::move(table));
+    registry.current.store(published.get(), std::memory_order::release);
+    registry.tables.push_back(std::move(published));
+}
+
+void put_(Table_& table, int typeId, QStringRenderer renderer)
+{
+    auto user = typeId >= QMetaType::User;
+    auto& slots = user ? table.user : table.builtin;
+    auto index = std::size_t(user ? typeId - QMetaType::User : typeId);
+
+    if (index >= slots.size())
+        slots.resize(index + 1, nullptr);
+
+    slots[index] = renderer;
+}
+
+// Renders T in place (the variant's own storage, no copy out of it)
+template <typename T> void render_(QString& out, const QVariant& variant)
+{
+    appendQString(out, *static_cast<const T*>(variant.constData()));
+}
+
+// Never destroyed, and starts with the types ToQString.h handles itself, so
+// the first lookup (possibly from another TU's static initializer) already
+// sees them
+Registry_& registry_()
+{
+    static auto registry = [] {
+        auto registry = new Registry_{};
+        Table_ table{};
+
+        put_(table, QMetaType::QVariantMap, render_<QVariantMap>);
+        put_(table, QMetaType::QVariantHash, render_<QVariantHash>);
+        put_(table, QMetaType::QVariantList, render_<QVariantList>);
+        put_(table, QMetaType::QStringList, render_<QStringList>);
+        put_(table, QMetaType::QModelIndex, render_<QModelIndex>);
+
+        put_(table, QMetaType::QPoint, render_<QPoint>);
+        put_(table, QMetaType::QPointF, render_<QPointF>);
+        put_(table, QMetaType::QSize, render_<QSize>);
+        put_(table, QMetaType::QSizeF, render_<QSizeF>);
+        put_(table, QMetaType::QRect, render_<QRect>);
+        put_(table, QMetaType::QRectF, render_<QRectF>);
+        put_(table, QMetaType::QLine, render_<QLine>);
+        put_(table, QMetaType::QLineF, render_<QLineF>);
+
+        put_(table, QMetaType::QJsonValue, render_<QJsonValue>);
+        put_(table, QMetaType::QJsonObject, render_<QJsonObject>);
+        put_(table, QMetaType::QJsonArray, render_<QJsonArray>);
+        put_(table, QMetaType::QJsonDocument, render_<QJsonDocument>);
+        put_(table, QMetaType::QCborValue, render_<QCborValue>);
+        put_(table, QMetaType::QCborArray, render_<QCborArray>);
+        put_(table, QMetaType::QCborMap, render_<QCborMap>);
+
+#ifdef COCO_HAS_XML
+        put_(
+            table,
+            QMetaType::fromType<QDomElement>().id(),
+            render_<QDomElement>);
+#endif
+
+        std::lock_guard<std::mutex> lock(registry->mutex);
+        publish_(*registry, std::move(table));
+        return registry;
+    }();
+
+    return *registry;
+}
+
+} // namespace
+
+void registerQStringRenderer(QMetaType type, QStringRenderer renderer)
+{
+    if (!type.isValid())
+        return;
+
+    auto& registry = registry_();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto table = *registry.current.load(std::memory_order::relaxed);
+    put_(table, type.id(), renderer);
+    publish_(registry, std::move(table));
+}
+
+namespace Internal {
+
+RenderLimits defaultRenderLimits_() noexcept
+{
+    return { maxElements_.load(std::memory_order::relaxed),
+             maxDepth_.load(std::memory_order::relaxed),
+             maxSize_.load(std::memory_order::relaxed) };
+}
+
+void setDefaultRenderLimits_(const RenderLimits& limits) noexcept
+{
+    maxElements_.store(limits.maxElements, std::memory_order::relaxed);
+    maxDepth_.store(limits.maxDepth, std::memory_order::relaxed);
+    maxSize_.store(limits.maxSize, std::memory_order::relaxed);
+}
+
+QStringRenderer qStringRenderer_(int typeId) noexcept
+{
+    if (typeId < 0)
+        return nullptr;
+
+    auto table = registry_().current.load(std::memory_order::acquire);
+    auto user = typeId >= QMetaType::User;
+    auto& slots = user ? table->user : table->builtin;
+    auto index = std::size_t(user ? typeId - QMetaType::User : typeId);
+
+    return index < slots.size() ? slots[index] : nullptr;
+}
+
+} // namespace Internal
+
+} // namespace Coco
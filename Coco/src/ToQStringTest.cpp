@@ -0,0 +1,306 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+// Coco::toQString test (and, with --bench, benchmark).
+//
+// Renders one QVariant of each type Qt's own QVariant::toString handles badly
+// or not at all (the dump that used to sit at the bottom of ToQString.h) and
+// checks the text. With --bench, also times big nested maps and JSON/CBOR
+// documents against QVariant::toString, QJsonDocument::toJson and
+// QCborValue::toDiagnosticNotation:
+//   CocoToQStringTest --bench --iterations 200
+
+#include <chrono>
+
+#include <QByteArray>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QChar>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLine>
+#include <QLineF>
+#include <QModelIndex>
+#include <QObject>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+#include <QUrl>
+#include <QVariant>
+#include <QVariantHash>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <Coco/ToQString.h>
+
+using namespace Qt::StringLiterals;
+using Clock = std::chrono::steady_clock;
+
+static int failures = 0;
+
+static void check(bool ok, const QString& name)
+{
+    if (ok) {
+        QTextStream(stdout) << "ok  : " << name << Qt::endl;
+    } else {
+        QTextStream(stderr) << "FAIL: " << name << Qt::endl;
+        ++failures;
+    }
+}
+
+static void
+expect(const QString& name, const QVariant& variant, const QString& want)
+{
+    auto got = Coco::toQString(variant);
+    check(got == want, name);
+
+    if (got != want) {
+        QTextStream(stderr) << "  got:  " << got << "\n  want: " << want
+                            << Qt::endl;
+    }
+}
+
+static void checkTypes()
+{
+    // --- Strings and numbers (QVariant::toString is fine for these) --------
+    expect(u"QString"_s, u"Hello"_s, u"Hello"_s);
+    expect(u"QByteArray"_s, QByteArray("Byte Array"), u"Byte Array"_s);
+    expect(u"QChar"_s, QChar(u'A'), u"A"_s);
+    expect(u"bool"_s, true, u"true"_s);
+    expect(u"int"_s, 55, u"55"_s);
+    expect(u"qulonglong"_s, 55ULL, u"55"_s);
+    expect(u"double"_s, 3.14159, u"3.14159"_s);
+    expect(u"QDate"_s, QDate(2025, 11, 12), u"2025-11-12"_s);
+    expect(u"QTime"_s, QTime(14, 30, 45), u"14:30:45.000"_s);
+    expect(
+        u"QUrl"_s,
+        QUrl(u"https://example.com"_s),
+        u"https://example.com"_s);
+
+    // --- Geometry ----------------------------------------------------------
+    expect(u"QPoint"_s, QPoint(10, 20), u"QPoint(x:10, y:20)"_s);
+    expect(u"QPointF"_s, QPointF(10.5, 20.5), u"QPointF(x:10.5, y:20.5)"_s);
+    expect(u"QSize"_s, QSize(100, 200), u"QSize(w:100, h:200)"_s);
+    expect(
+        u"QSizeF"_s,
+        QSizeF(100.5, 200.5),
+        u"QSizeF(w:100.5, h:200.5)"_s);
+    expect(
+        u"QRect"_s,
+        QRect(10, 20, 100, 200),
+        u"QRect(x:10, y:20, w:100, h:200)"_s);
+    expect(
+        u"QRectF"_s,
+        QRectF(10.5, 20.5, 100.5, 200.5),
+        u"QRectF(x:10.5, y:20.5, w:100.5, h:200.5)"_s);
+    expect(
+        u"QLine"_s,
+        QLine(0, 0, 100, 100),
+        u"QLine(x1:0, y1:0, x2:100, y2:100)"_s);
+    expect(
+        u"QLineF"_s,
+        QLineF(0.0, 0.0, 100.5, 100.5),
+        u"QLineF(x1:0, y1:0, x2:100.5, y2:100.5)"_s);
+
+    // --- Containers --------------------------------------------------------
+    expect(
+        u"QStringList"_s,
+        QStringList{ u"one"_s, u"two"_s, u"three"_s },
+        u"one, two, three"_s);
+    expect(
+        u"QVariantList"_s,
+        QVariantList{ 1, u"two"_s, 3.0 },
+        u"QVariantList(1, two, 3)"_s);
+    expect(
+        u"QVariantMap"_s,
+        QVariantMap{ { u"key1"_s, 1 }, { u"key2"_s, u"value"_s } },
+        u"QVariantMap({ \"key1\", 1 }, { \"key2\", value })"_s);
+    expect(
+        u"QVariantHash"_s,
+        QVariantHash{ { u"key1"_s, 1 } },
+        u"QVariantHash({ \"key1\", 1 })"_s);
+    expect(
+        u"QModelIndex"_s,
+        QVariant::fromValue(QModelIndex()),
+        u"QModelIndex(Invalid)"_s);
+
+    // --- JSON --------------------------------------------------------------
+    QJsonObject object{ { u"key"_s, u"value"_s } };
+
+    expect(
+        u"QJsonValue"_s,
+        QVariant::fromValue(QJsonValue(u"json string"_s)),
+        u"\"json string\""_s);
+    expect(
+        u"QJsonObject"_s,
+        QVariant::fromValue(object),
+        u"{\"key\":\"value\"}"_s);
+    expect(
+        u"QJsonArray"_s,
+        QVariant::fromValue(
+            QJsonArray{ u"one"_s, 2, 2.5, true, QJsonValue() }),
+        u"[\"one\",2,2.5,true,null]"_s);
+    expect(
+        u"QJsonDocument"_s,
+        QVariant::fromValue(QJsonDocument(object)),
+        u"{\"key\":\"value\"}"_s);
+    expect(
+        u"QJsonValue (escapes)"_s,
+        QVariant::fromValue(QJsonValue(u"a\"b\\c\n\x01"_s)),
+        u"\"a\\\"b\\\\c\\n\\u0001\""_s);
+
+    // --- CBOR --------------------------------------------------------------
+    expect(
+        u"QCborValue"_s,
+        QVariant::fromValue(QCborValue(u"cbor string"_s)),
+        u"\"cbor string\""_s);
+    expect(
+        u"QCborArray"_s,
+        QVariant::fromValue(QCborArray{ u"one"_s, 2, 2.5, 1.0 }),
+        u"[\"one\", 2, 2.5, 1.0]"_s);
+    expect(
+        u"QCborMap"_s,
+        QVariant::fromValue(QCborMap{ { 1, u"value"_s } }),
+        u"{1: \"value\"}"_s);
+    expect(
+        u"QCborValue (bytes)"_s,
+        QVariant::fromValue(QCborValue(QByteArray("\x0a\xff", 2))),
+        u"h'0aff'"_s);
+    expect(
+        u"QCborValue (tag)"_s,
+        QVariant::fromValue(QCborValue(QCborTag(42), u"x"_s)),
+        u"42(\"x\")"_s);
+
+    // --- Special -----------------------------------------------------------
+    expect(u"Invalid"_s, QVariant(), u"QVariant(Invalid)"_s);
+    expect(u"Null QString"_s, QVariant(QString()), u"QVariant(Null)"_s);
+
+    QObject qobject{};
+    check(
+        Coco::toQString(QVariant::fromValue(&qobject)).startsWith(u"QObject("),
+        u"QObject*"_s);
+
+    // --- Limits ------------------------------------------------------------
+    check(
+        Coco::toQString(QJsonArray{ 1, 2, 3 }, { .maxElements = 2 }) ==
+            u"[1,2,... (+1 more)]"_s,
+        u"QJsonArray (limited)"_s);
+}
+
+// --- Benchmark -------------------------------------------------------------
+
+template <typename FnT>
+static void timeRenders(const QString& name, int iterations, FnT fn)
+{
+    qsizetype size = 0;
+    auto begin = Clock::now();
+
+    for (auto i = 0; i < iterations; ++i)
+        size += fn().size();
+
+    auto end = Clock::now();
+    auto micros =
+        std::chrono::duration<double, std::micro>(end - begin).count() /
+        iterations;
+
+    QTextStream(stdout) << qSetFieldWidth(36) << Qt::left << name
+                        << qSetFieldWidth(0) << QString::number(micros, 'f', 1)
+                        << " us/render (" << size / iterations << " chars)"
+                        << Qt::endl;
+}
+
+static void bench(int iterations)
+{
+    // 1000 entries, each a small map of mixed values
+    QVariantMap map{};
+    QJsonObject json{};
+    QCborMap cbor{};
+
+    for (auto i = 0; i < 1000; ++i) {
+        auto key = u"key%1"_s.arg(i);
+        QVariantMap inner{ { u"id"_s, i },
+                           { u"name"_s, u"item"_s },
+                           { u"ratio"_s, i / 7.0 },
+                           { u"pos"_s, QPointF(i, -i) } };
+
+        map.insert(key, inner);
+        json.insert(key, QJsonObject::fromVariantMap(inner));
+        cbor.insert(key, QCborMap::fromVariantMap(inner));
+    }
+
+    QVariant variant = map;
+
+    timeRenders(u"toQString(QVariantMap)"_s, iterations, [&] {
+        return Coco::toQString(variant);
+    });
+    timeRenders(u"QVariant::toString (QVariantMap)"_s, iterations, [&] {
+        return variant.toString();
+    });
+    timeRenders(u"toQString(QJsonObject)"_s, iterations, [&] {
+        return Coco::toQString(json);
+    });
+    timeRenders(u"QJsonDocument::toJson"_s, iterations, [&] {
+        return QString::fromUtf8(
+            QJsonDocument(json).toJson(QJsonDocument::Compact));
+    });
+    timeRenders(u"toQString(QCborMap)"_s, iterations, [&] {
+        return Coco::toQString(cbor);
+    });
+    timeRenders(u"QCborValue::toDiagnosticNotation"_s, iterations, [&] {
+        return QCborValue(cbor).toDiagnosticNotation();
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser{};
+    parser.setApplicationDescription(u"Coco::toQString test"_s);
+    parser.addHelpOption();
+
+    QCommandLineOption bench_option(
+        u"bench"_s,
+        u"Also time large renders against Qt's own"_s);
+    QCommandLineOption iterations_option(
+        u"iterations"_s,
+        u"Renders per benchmark case"_s,
+        u"n"_s,
+        u"100"_s);
+
+    parser.addOptions({ bench_option, iterations_option });
+    parser.process(app);
+
+    checkTypes();
+
+    if (parser.isSet(bench_option))
+        bench(qMax(parser.value(iterations_option).toInt(), 1));
+
+    QTextStream(stdout) << (failures ? "FAILED" : "passed") << " ("
+                        << failures << " failures)" << Qt::endl;
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * Coco — Common code for Qt projects
+ * Copyright (C) 2025-2026 fairybow
+ *
+ * This program is free software, redistributable and/or modifiable under the
+ * terms of the GNU GPL v3. It's distributed in the hope that it will be useful
+ * but without any warranty (even the implied warranty of merchantability or
+ * fitness for a particular purpose)
+ *
+ * See the LICENSE file or visit <https://www.gnu.org/licenses/>
+ */
+
+#include "Coco/Walk.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "Coco/DirEntry.h"
+#include "Coco/Path.h"
+
+#include "DirReader.h"
+
+namespace Coco::Internal {
+
+// One open directory per level, so memory follows depth, not tree size
+struct WalkState
+{
+    struct Frame
+    {
+        QString prefix;
+        int depth;
+
+        // Opened on first read, so a directory pushed just before the loop
+        // breaks is never opened
+        std::unique_ptr<DirReader> reader{};
+    };
+
+    EntryFilter filter;
+    int maxDepth;
+    std::function<bool(const Path&)> prune;
+    bool stat;
+    std::vector<Frame> frames{};
+    ListedEntry listed{};
+
+    // With FollowSymlinks, every directory entered (by canonical path), so a
+    // link back up the tree isn't followed twice
+    QSet<QString> visited{};
+
+    explicit WalkState(const WalkOptions& options)
+        : filter(options.exts, options.filters, options.flags)
+        , maxDepth(options.maxDepth)
+        , prune(options.prune)
+        , stat(options.stat)
+    {
+    }
+
+    void push(const Path& dir, int depth)
+    {
+        auto prefix = dir.toQString();
+
+        if (!prefix.isEmpty() && !prefix.endsWith(u'/') &&
+            !prefix.endsWith(QDir::separator()))
+            prefix += u'/';
+
+        frames.push_back({ std::move(prefix), depth });
+    }
+
+    // False if the directory was already entered (only tracked with
+    // FollowSymlinks, as QDirIterator does)
+    bool visit(const Path& dir)
+    {
+        if (!(filter.flags() & QDirIterator::FollowSymlinks))
+            return true;
+
+        auto canonical = QFileInfo(dir.toQString()).canonicalFilePath();
+
+        if (visited.contains(canonical))
+            return false;
+
+        visited.insert(canonical);
+        return true;
+    }
+
+    bool next(DirEntry& entry, int& depth)
+    {
+        while (!frames.empty()) {
+            auto& frame = frames.back();
+
+            if (!frame.reader)
+                frame.reader = std::make_unique<DirReader>(frame.prefix);
+
+            if (!frame.reader->next(listed)) {
+                frames.pop_back();
+                continue;
+            }
+
+            auto level = frame.depth;
+            auto matches = filter.matches(*frame.reader, listed);
+            auto descends = (maxDepth < 0 || level < maxDepth) &&
+                            filter.descends(listed);
+
+            if (!matches && !descends)
+                continue;
+
+            Path path(frame.prefix + listed.name);
+
+            // While the reader still has this entry
+            auto has_stat = matches && stat && frame.reader->stat(listed);
+
+            // Pushed now (invalidating frame), read once this entry is
+            // consumed: each directory comes before its contents
+            if (descends && !(prune && prune(path)) && visit(path))
+                push(path, level + 1);
+
+            if (!matches)
+                continue;
+
+            entry = listed.toDirEntry(std::move(path), has_stat);
+            depth = level;
+            return true;
+        }
+
+        entry = {};
+        return false;
+    }
+};
+
+} // namespace Coco::Internal
+
+namespace Coco {
+
+template <typename T>
+BasicWalk<T>::BasicWalk(const Path& dir, WalkOptions options)
+    : state_(std::make_unique<Internal::WalkState>(options))
+{
+    if (state_->visit(dir))
+        state_->push(dir, 0);
+}
+
+template <typename T> BasicWalk<T>::~BasicWalk() = default;
+template <typename T> BasicWalk<T>::BasicWalk(BasicWalk&&) noexcept = default;
+
+template <typename T>
+BasicWalk<T>& BasicWalk<T>::operator=(BasicWalk&&) noexcept = default;
+
+template <typename T> void BasicWalk<T>::advance_()
+{
+    done_ = !state_->next(entry_, depth_);
+}
+
+template class BasicWalk<Path>;
+template class BasicWalk<DirEntry>;
+
+PathList paths(
+    const Path& dir,
+    const QStringList& exts,
+    QDir::Filters filters,
+    QDirIterator::IteratorFlags flags)
+{
+    PathList result{};
+    WalkOptions options{ .exts = exts, .filters = filters, .flags = flags };
+
+    for (auto& path : walk(dir, std::move(options)))
+        result << path;
+
+    return result;
+}
+
+PathList paths(
+    const PathList& dirs,
+    const QStringList& exts,
+    QDir::Filters filters,
+    QDirIterator::IteratorFlags flags)
+{
+    PathList result{};
+
+    for (auto& dir : dirs)
+        result << paths(dir, exts, filters, flags);
+
+    return result;
+}
+
+DirEntryList dirEntries(
+    const Path& dir,
+    const QStringList& exts,
+    QDir::Filters filters,
+    QDirIterator::IteratorFlags flags)
+{
+    DirEntryList result{};
+    WalkOptions options{ .exts = exts,
+                         .filters = filters,
+                         .flags = flags,
+                         .stat = true };
+
+    for (auto& entry : walkEntries(dir, std::move(options)))
+        result << entry;
+
+    return result;
+}
+
+} // namespace Coco